@@ -18,7 +18,6 @@
 /************************************************************************************************************/
 /************************************************************************************************************/
 
-#include <pthread.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -38,12 +37,11 @@
 
 static void _callback_button_close (dg_core_cell_t *c);
 static void _callback_button_conf  (dg_core_cell_t *c);
-static void _callback_signal       (uint32_t serial);
 static void _callback_reconfig     (void);
+static void _callback_timer        (dg_core_timer_t *t);
 
-static void  _time_reset  (void);
-static void  _time_setup  (void);
-static void *_time_thread (void *arg);
+static void _time_reset (void);
+static void _time_setup (void);
 
 static void _ui_place (void);
 static void _ui_reset (void);
@@ -60,7 +58,7 @@ static dg_core_cell_t   *_c_conf  = NULL;
 static dg_core_cell_t   *_c_close = NULL;
 static dg_core_cell_t   *_c_clock = NULL;
 
-static pthread_t _timer;
+static dg_core_timer_t *_timer = NULL;
 
 /************************************************************************************************************/
 /************************************************************************************************************/
@@ -115,12 +113,12 @@ _callback_reconfig(void)
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 static void
-_callback_signal(uint32_t serial)
+_callback_timer(dg_core_timer_t *t)
 {
 	/* get time */
 
-	time_t     t = time(NULL);
-	struct tm *T = localtime(&t);
+	time_t     now = time(NULL);
+	struct tm *T   = localtime(&now);
 
 	/* update clock label */
 
@@ -136,7 +134,7 @@ _callback_signal(uint32_t serial)
 static void
 _time_reset(void)
 {
-	pthread_cancel(_timer);
+	dg_core_timer_destroy(_timer);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -144,20 +142,11 @@ _time_reset(void)
 static void
 _time_setup(void)
 {
-	pthread_create(&_timer, NULL, _time_thread, NULL);
-}
-
-/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+	/* update the clock right away, then every second */
 
-static void *
-_time_thread(void *arg)
-{
-	while (1) {
-		dg_core_loop_send_signal(1);
-		sleep(1);
-	}
+	_timer = dg_core_timer_create(_callback_timer, NULL);
 
-	pthread_exit(NULL);
+	dg_core_timer_start(_timer, 0, 1000000);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -229,10 +218,8 @@ _ui_setup(int argc, char **argv)
 	dg_base_init();
 
 	/* add DG resource tracking to update position of bar on reconfigs */
-	/* add DG signal tracking to update the clock's value              */
 
 	dg_core_resource_set_callback(_callback_reconfig);
-	dg_core_loop_set_callback_signal(_callback_signal);
 
 	/* object instantiation */
 
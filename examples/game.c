@@ -198,6 +198,7 @@ main(int argc, char **argv)
 
 	dg_core_window_push_grid(_w, _g);
 	dg_core_window_set_callback_redraw(_w, _callback_main_draw);
+	dg_core_window_set_low_latency(_w, true);
 	dg_core_window_rename(_w, "Pressure Control Game", NULL);
 	dg_core_window_activate(_w);
 
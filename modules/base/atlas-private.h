@@ -0,0 +1,67 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#ifndef DG_BASE_ATLAS_H_PRIVATE
+#define DG_BASE_ATLAS_H_PRIVATE
+
+#include <stdbool.h>
+
+#include <cairo/cairo.h>
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+/**
+ * Starts rasterizing the printable ASCII glyphs of both font variants into their atlases on a background
+ * thread, if the core's config selects the atlas font backend. Atlas draws do not wait for it, glyphs it has
+ * not reached yet are rasterized on demand. Failing to start the thread is not an error either.
+ */
+void dg_base_atlas_init(void);
+
+/**
+ * Waits for the prewarming thread if it is still running, then frees the atlases.
+ */
+void dg_base_atlas_reset(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Draws positioned glyphs with the context's current source by masking it with the glyphs' atlas entries.
+ * Glyphs missing from the atlas are rasterized into it first. If the core's font generation changed since
+ * the last call, the atlas of the requested font variant is rebuilt. Glyphs that cannot be put into the
+ * atlas are drawn with cairo_show_glyphs() instead, using the context's current font.
+ *
+ * @param c_ctx    : cairo context to draw to
+ * @param glyphs   : glyphs to draw, with their baseline positions in user space
+ * @param glyphs_n : number of glyphs
+ * @param bold     : font variant to use
+ *
+ * @return : false if the atlas is not available and nothing was drawn, true otherwhise
+ *
+ * @error DG_CORE_ERRNO_CAIRO : atlas setup or glyph rasterization failure
+ */
+bool dg_base_atlas_show_glyphs(cairo_t *c_ctx, const cairo_glyph_t *glyphs, int glyphs_n, bool bold);
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#endif /* DG_BASE_ATLAS_H_PRIVATE */
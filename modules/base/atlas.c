@@ -0,0 +1,448 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#include <assert.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include <cairo/cairo.h>
+
+#include <dg/core/config.h>
+#include <dg/core/errno.h>
+#include <dg/core/map.h>
+
+#include "atlas-private.h"
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#define _PAGE_COLS 32
+#define _PAGE_ROWS 8
+#define _PAGE_N    (_PAGE_COLS * _PAGE_ROWS)
+
+#define _PREWARM_STR " !\"#$%&'()*+,-./0123456789:;<=>?@ABCDEFGHIJKLMNOPQRSTUVWXYZ[\\]^_`abcdefghijklmnopqrstuvwxyz{|}~"
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Glyph atlas of a single font variant. Glyphs are rasterized in A8 pages split in cells large enough to fit
+ * any glyph of the font with some margin for overhangs. Each rasterized glyph gets a subsurface limited to
+ * its cell, so that drawing it is a single mask operation. Pages and cells are only ever appended to, so a
+ * cell handed out is never moved nor written again until the whole atlas is cleared, which lets threads
+ * mask from it without holding the atlas lock.
+ *
+ * @param c_sft     : font reference the atlas is built from
+ * @param gen       : core's font generation the atlas was built against, 0 if it was never built
+ * @param failed    : the atlas could not be set up and should not be used
+ * @param cell_pw   : pixel width  of a cell
+ * @param cell_ph   : pixel height of a cell
+ * @param origin_x  : horizontal position of the glyph origin within its cell
+ * @param origin_y  : vertical   position of the glyph origin (baseline) within its cell
+ * @param pages     : A8 image surfaces holding the rasterized glyphs
+ * @param n_pages   : number of pages
+ * @param n_entries : number of used cells across all pages
+ * @param entries   : map of glyph indices to their cell subsurface, or to _blank for glyphs without ink
+ */
+typedef struct {
+	cairo_scaled_font_t *c_sft;
+	unsigned int gen;
+	bool failed;
+	int16_t cell_pw;
+	int16_t cell_ph;
+	int16_t origin_x;
+	int16_t origin_y;
+	cairo_surface_t **pages;
+	size_t n_pages;
+	size_t n_entries;
+	dg_core_map_t entries;
+} _atlas_t;
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+static void _atlas_clear   (_atlas_t *a);
+static void _atlas_prewarm (_atlas_t *a);
+static void _sync          (void);
+
+static bool _atlas_add_page (_atlas_t *a);
+static bool _atlas_setup    (_atlas_t *a, bool bold);
+static bool _show_glyphs    (cairo_t *c_ctx, const cairo_glyph_t *glyphs, int glyphs_n, bool bold);
+
+static const void *_atlas_add  (_atlas_t *a, unsigned long index);
+static const void *_atlas_find (_atlas_t *a, unsigned long index);
+static void       *_prewarm    (void *arg);
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+static _atlas_t _atlases[2] = {0};
+
+static const char _blank = 0;
+
+static pthread_t       _thread;
+static bool            _thread_running = false;
+static pthread_mutex_t _thread_mutex   = PTHREAD_MUTEX_INITIALIZER; /* several render threads may join it */
+
+static pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+
+/************************************************************************************************************/
+/* PRIVATE **************************************************************************************************/
+/************************************************************************************************************/
+
+void
+dg_base_atlas_init(void)
+{
+	if (DG_CORE_CONFIG->ft_backend != DG_CORE_CONFIG_FONT_ATLAS) {
+		return;
+	}
+
+	/* setup is cheap and done here, only the rasterization is deferred to the thread */
+
+	for (size_t i = 0; i < 2; i++) {
+		if (!_atlas_setup(&_atlases[i], i == 1)) {
+			_atlas_clear(&_atlases[0]);
+			_atlas_clear(&_atlases[1]);
+			return;
+		}
+	}
+
+	/* draws share the atlases with the thread under _mutex and rasterize what it hasn't reached yet */
+	/* if the thread can't start, glyphs will just all be rasterized on demand                       */
+
+	_thread_running = pthread_create(&_thread, NULL, _prewarm, NULL) == 0;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_base_atlas_reset(void)
+{
+	_sync();
+
+	_atlas_clear(&_atlases[0]);
+	_atlas_clear(&_atlases[1]);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+bool
+dg_base_atlas_show_glyphs(cairo_t *c_ctx, const cairo_glyph_t *glyphs, int glyphs_n, bool bold)
+{
+	assert(c_ctx && glyphs);
+
+	return _show_glyphs(c_ctx, glyphs, glyphs_n, bold);
+}
+
+/************************************************************************************************************/
+/* _ ********************************************************************************************************/
+/************************************************************************************************************/
+
+static const void *
+_atlas_add(_atlas_t *a, unsigned long index)
+{
+	cairo_glyph_t glyph = {.index = index, .x = 0, .y = 0};
+	cairo_text_extents_t t_e;
+
+	/* don't waste a cell on glyphs that have nothing to draw, like spaces */
+
+	cairo_scaled_font_glyph_extents(a->c_sft, &glyph, 1, &t_e);
+	if (t_e.width <= 0 || t_e.height <= 0) {
+		return dg_core_map_set(&a->entries, index, &_blank) ? &_blank : NULL;
+	}
+
+	/* find next free cell */
+
+	const size_t i_page = a->n_entries / _PAGE_N;
+	const size_t i_cell = a->n_entries % _PAGE_N;
+
+	if (i_page == a->n_pages && !_atlas_add_page(a)) {
+		return NULL;
+	}
+
+	const int16_t x = (i_cell % _PAGE_COLS) * a->cell_pw;
+	const int16_t y = (i_cell / _PAGE_COLS) * a->cell_ph;
+
+	a->n_entries++;
+
+	/* rasterize the glyph in its cell */
+
+	cairo_t *c_ctx = cairo_create(a->pages[i_page]);
+
+	glyph.x = x + a->origin_x;
+	glyph.y = y + a->origin_y;
+
+	cairo_set_scaled_font(c_ctx, a->c_sft);
+	cairo_show_glyphs(c_ctx, &glyph, 1);
+	cairo_destroy(c_ctx);
+
+	/* reference the cell */
+
+	cairo_surface_t *c_srf = cairo_surface_create_for_rectangle(
+		a->pages[i_page],
+		x,
+		y,
+		a->cell_pw,
+		a->cell_ph);
+	if (cairo_surface_status(c_srf) != CAIRO_STATUS_SUCCESS) {
+		cairo_surface_destroy(c_srf);
+		return NULL;
+	}
+
+	if (!dg_core_map_set(&a->entries, index, c_srf)) {
+		cairo_surface_destroy(c_srf);
+		return NULL;
+	}
+
+	return c_srf;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_atlas_add_page(_atlas_t *a)
+{
+	cairo_surface_t **tmp = realloc(a->pages, (a->n_pages + 1) * sizeof(cairo_surface_t*));
+	if (!tmp) {
+		return false;
+	}
+
+	a->pages = tmp;
+
+	cairo_surface_t *c_srf = cairo_image_surface_create(
+		CAIRO_FORMAT_A8,
+		_PAGE_COLS * a->cell_pw,
+		_PAGE_ROWS * a->cell_ph);
+	if (cairo_surface_status(c_srf) != CAIRO_STATUS_SUCCESS) {
+		cairo_surface_destroy(c_srf);
+		return false;
+	}
+
+	a->pages[a->n_pages++] = c_srf;
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_atlas_clear(_atlas_t *a)
+{
+	for (uint32_t i = 0; i < a->entries.n_alloc; i++) {
+		if (a->entries.slots[i].val && a->entries.slots[i].val != &_blank) {
+			cairo_surface_destroy((cairo_surface_t*)a->entries.slots[i].val);
+		}
+	}
+
+	for (size_t i = 0; i < a->n_pages; i++) {
+		cairo_surface_destroy(a->pages[i]);
+	}
+
+	dg_core_map_reset(&a->entries);
+	cairo_scaled_font_destroy(a->c_sft);
+	free(a->pages);
+
+	*a = (_atlas_t){.entries = DG_CORE_MAP_EMPTY};
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_atlas_prewarm(_atlas_t *a)
+{
+	int glyphs_n = 0;
+	cairo_glyph_t *glyphs = NULL;
+	cairo_status_t status;
+
+	status = cairo_scaled_font_text_to_glyphs(a->c_sft, 0, 0, _PREWARM_STR, -1, &glyphs, &glyphs_n, NULL, NULL,
+	                                          NULL);
+	if (status != CAIRO_STATUS_SUCCESS) {
+		return;
+	}
+
+	/* glyphs are inserted one at a time so that draws can go on meanwhile, rasterizing what they miss */
+
+	for (int i = 0; i < glyphs_n; i++) {
+		pthread_mutex_lock(&_mutex);
+		if (glyphs[i].index <= UINT32_MAX && !dg_core_map_get(&a->entries, glyphs[i].index)) {
+			_atlas_add(a, glyphs[i].index);
+		}
+		pthread_mutex_unlock(&_mutex);
+	}
+
+	cairo_glyph_free(glyphs);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_atlas_setup(_atlas_t *a, bool bold)
+{
+	cairo_scaled_font_t *c_sft = bold ? DG_CORE_CONFIG->ft_c_sft_bold : DG_CORE_CONFIG->ft_c_sft_normal;
+	if (!c_sft) {
+		return false;
+	}
+
+	/* size cells after the font's own extents instead of ft_pw & ft_ph as those can be overridden */
+
+	cairo_font_extents_t f_e;
+
+	cairo_scaled_font_extents(c_sft, &f_e);
+
+	const int16_t margin = ceil(f_e.height / 8.0) + 1;
+
+	a->c_sft    = cairo_scaled_font_reference(c_sft);
+	a->gen      = DG_CORE_CONFIG->ft_generation;
+	a->failed   = false;
+	a->origin_x = margin;
+	a->origin_y = margin + ceil(f_e.ascent);
+	a->cell_pw  = margin * 2 + ceil(f_e.max_x_advance);
+	a->cell_ph  = margin * 2 + ceil(f_e.ascent + f_e.descent);
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static const void *
+_atlas_find(_atlas_t *a, unsigned long index)
+{
+	if (index > UINT32_MAX) {
+		return NULL;
+	}
+
+	/* render threads share the atlases, but only lookups and insertions need the lock, the entry is */
+	/* referenced so that it outlives the mask operation done by the caller without it               */
+
+	pthread_mutex_lock(&_mutex);
+
+	const void *entry = dg_core_map_get(&a->entries, index);
+	if (!entry) {
+		entry = _atlas_add(a, index);
+	}
+
+	if (entry && entry != &_blank) {
+		cairo_surface_reference((cairo_surface_t*)entry);
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	return entry;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void *
+_prewarm(void *arg)
+{
+	(void)arg;
+
+	_atlas_prewarm(&_atlases[0]);
+	_atlas_prewarm(&_atlases[1]);
+
+	return NULL;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_show_glyphs(cairo_t *c_ctx, const cairo_glyph_t *glyphs, int glyphs_n, bool bold)
+{
+	_atlas_t *a = &_atlases[bold ? 1 : 0];
+
+	/* rebuild after reconfigs, reconfigs never happen while cells are being drawn, but the prewarming  */
+	/* thread may still be filling the old atlas, it is waited for without the lock it needs to finish  */
+
+	pthread_mutex_lock(&_mutex);
+
+	if (a->gen != DG_CORE_CONFIG->ft_generation) {
+		pthread_mutex_unlock(&_mutex);
+		_sync();
+		pthread_mutex_lock(&_mutex);
+	}
+
+	if (a->gen != DG_CORE_CONFIG->ft_generation) {
+		_atlas_clear(a);
+		if (!_atlas_setup(a, bold)) {
+			dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
+			a->gen    = DG_CORE_CONFIG->ft_generation;
+			a->failed = true;
+		}
+	}
+
+	const bool    failed   = a->failed;
+	const int16_t origin_x = a->origin_x;
+	const int16_t origin_y = a->origin_y;
+
+	pthread_mutex_unlock(&_mutex);
+
+	if (failed) {
+		return false;
+	}
+
+	/* draw */
+
+	const void *entry;
+
+	for (int i = 0; i < glyphs_n; i++) {
+
+		entry = _atlas_find(a, glyphs[i].index);
+
+		if (!entry) {
+			dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
+			cairo_show_glyphs(c_ctx, glyphs + i, 1);
+			continue;
+		}
+
+		if (entry == &_blank) {
+			continue;
+		}
+
+		cairo_mask_surface(
+			c_ctx,
+			(cairo_surface_t*)entry,
+			glyphs[i].x - origin_x,
+			glyphs[i].y - origin_y);
+
+		cairo_surface_destroy((cairo_surface_t*)entry);
+	}
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_sync(void)
+{
+	pthread_mutex_lock(&_thread_mutex);
+
+	if (_thread_running) {
+		pthread_join(_thread, NULL);
+		_thread_running = false;
+	}
+
+	pthread_mutex_unlock(&_thread_mutex);
+}
@@ -24,10 +24,18 @@
 #include <dg/core/core.h>
 #include <dg/core/errno.h>
 
+#include "atlas-private.h"
 #include "base.h"
 #include "base-private.h"
 #include "config.h"
 #include "config-private.h"
+#include "draw.h"
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+static void _draw_batch (cairo_t *c_ctx, bool open);
 
 /************************************************************************************************************/
 /************************************************************************************************************/
@@ -63,6 +71,14 @@ dg_base_init(void)
 		_type_serials[i] = dg_core_get_serial();
 	}
 
+	/* rasterize common glyphs in the background while the application sets itself up */
+
+	dg_base_atlas_init();
+
+	/* let the core batch the drawing operations of all the cells of a frame */
+
+	dg_core_set_callback_draw_batch(_draw_batch);
+
 	/* end of initialisation */
 
 	_init = true;
@@ -81,6 +97,9 @@ dg_base_is_init(void)
 void
 dg_base_reset(void)
 {
+	dg_core_set_callback_draw_batch(NULL);
+	dg_base_draw_batch_end();
+	dg_base_atlas_reset();
 	dg_base_config_reset();
 
 	for (size_t i = 0; i < DG_BASE_ENUM_END; i++) {
@@ -107,3 +126,17 @@ dg_base_is_cell_type(dg_core_cell_t *c, dg_base_cell_t type)
 {
 	return c && dg_core_cell_get_serial(c) == dg_base_get_type_serial(type);
 }
+
+/************************************************************************************************************/
+/* _ ********************************************************************************************************/
+/************************************************************************************************************/
+
+static void
+_draw_batch(cairo_t *c_ctx, bool open)
+{
+	if (open) {
+		dg_base_draw_batch_begin(c_ctx);
+	} else {
+		dg_base_draw_batch_end();
+	}
+}
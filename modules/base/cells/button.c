@@ -148,6 +148,8 @@ dg_base_button_create(void)
 	props->fn_press = NULL;
 	props->fn_icon  = NULL;
 
+	dg_core_cell_set_threaded(c, true);
+
 	return c;
 }
 
@@ -159,7 +161,13 @@ dg_base_button_set_callback_icon(dg_core_cell_t *c, void (*fn)(dg_core_cell_t *c
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_BUTTON);
 
+	dg_core_cell_lock(c);
 	_PROPS->fn_icon = fn;
+	dg_core_cell_unlock(c);
+
+	/* the callback runs while the cell is drawn, it may not be safe to call off the loop thread */
+
+	dg_core_cell_set_threaded(c, !fn);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -170,7 +178,9 @@ dg_base_button_set_callback_pressed(dg_core_cell_t *c, void (*fn)(dg_core_cell_t
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_BUTTON);
 
+	dg_core_cell_lock(c);
 	_PROPS->fn_press = fn;
+	dg_core_cell_unlock(c);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -181,7 +191,9 @@ dg_base_button_set_icon(dg_core_cell_t *c, dg_base_button_icon_t icon)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_BUTTON);
 
+	dg_core_cell_lock(c);
 	_PROPS->icon = icon;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -194,7 +206,9 @@ dg_base_button_set_label(dg_core_cell_t *c, const char *str)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_BUTTON);
 	
+	dg_core_cell_lock(c);
 	dg_base_string_set(&_PROPS->label, str);
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -207,7 +221,9 @@ dg_base_button_set_label_origin(dg_core_cell_t *c, dg_base_origin_t og)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_BUTTON);
 	
+	dg_core_cell_lock(c);
 	_PROPS->label_og = og;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -109,6 +109,8 @@ dg_base_gauge_create(void)
 	dg_base_string_set(&_PROPS->units,    "%");
 	dg_base_string_set(&_PROPS->label, "__0%");
 
+	dg_core_cell_set_threaded(c, true);
+
 	return c;
 }
 
@@ -120,7 +122,9 @@ dg_base_gauge_hide_label(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_GAUGE);
 
+	dg_core_cell_lock(c);
 	_PROPS->show_label = false;
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -133,7 +137,9 @@ dg_base_gauge_set_horizontal(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_GAUGE);
 
+	dg_core_cell_lock(c);
 	_PROPS->horz = true;
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -146,10 +152,12 @@ dg_base_gauge_set_label_style(dg_core_cell_t *c, int precision, const char *unit
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_GAUGE);
 
+	dg_core_cell_lock(c);
 	dg_base_string_set(&_PROPS->units, units);
 	_PROPS->precision = precision;
 
 	_update_label(c);
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -164,10 +172,12 @@ dg_base_gauge_set_limits(dg_core_cell_t *c, double min, double max)
 
 	assert(max > min);
 
+	dg_core_cell_lock(c);
 	_PROPS->min = min;
 	_PROPS->max = max;
 
 	_update_label(c);
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -180,10 +190,12 @@ dg_base_gauge_set_value(dg_core_cell_t *c, double value)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_GAUGE);
 
+	dg_core_cell_lock(c);
 	_PROPS->val     = value;
 	_PROPS->unknown = false;
 
 	_update_label(c);
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -196,7 +208,9 @@ dg_base_gauge_set_value_unknown(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_GAUGE);
 
+	dg_core_cell_lock(c);
 	_PROPS->unknown = true;
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -209,7 +223,9 @@ dg_base_gauge_set_vertical(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_GAUGE);
 
+	dg_core_cell_lock(c);
 	_PROPS->horz = false;
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -222,7 +238,9 @@ dg_base_gauge_show_label(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_GAUGE);
 
+	dg_core_cell_lock(c);
 	_PROPS->show_label = true;
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -247,8 +265,16 @@ _animate(dg_core_cell_t *c, dg_core_cell_drawing_context_t *dc)
 		_PROPS->anim_pos  = (_PROPS->anim_pos < 0 ? 0 : l * 2) - _PROPS->anim_pos;
 		_PROPS->anim_dir *= -1;
 	}
-	
-	dc->msg |= DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE;
+
+	/* only the bar moves, within the foreground */
+
+	const dg_base_zone_t zf = dg_base_zone_get_foreground(dc, _STYLE);
+
+	dc->msg      |= DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE_REGION;
+	dc->update_px = zf.px - dc->cell_px;
+	dc->update_py = zf.py - dc->cell_py;
+	dc->update_pw = zf.pw;
+	dc->update_ph = zf.ph;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
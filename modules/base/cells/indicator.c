@@ -24,6 +24,7 @@
 #include <dg/core/core.h>
 #include <dg/core/config.h>
 #include <dg/core/errno.h>
+#include <dg/core/util.h>
 
 #include "../base.h"
 #include "../base-private.h"
@@ -57,7 +58,7 @@ typedef struct {
 	dg_base_origin_t label_og;
 	bool blink_on;
 	void (*fn_blink)(dg_core_cell_t *c, bool crit_on);
-	unsigned long anim_count;
+	unsigned long anim_next; /* time of the next blink, 0 if not scheduled yet */
 	unsigned int  anim_multi;
 } _props_t;
 
@@ -98,7 +99,9 @@ dg_base_indicator_create(void)
 	props->blink_on   = false;
 	props->fn_blink   = NULL; 
 	props->anim_multi = 1;
-	props->anim_count = 0;
+	props->anim_next  = 0;
+
+	dg_core_cell_set_threaded(c, true);
 
 	return c;
 }
@@ -111,7 +114,13 @@ dg_base_indicator_set_callback_blink(dg_core_cell_t *c, void (*fn)(dg_core_cell_
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_INDICATOR);
 	
+	dg_core_cell_lock(c);
 	_PROPS->fn_blink = fn;
+	dg_core_cell_unlock(c);
+
+	/* the callback runs while the cell is drawn, it may not be safe to call off the loop thread */
+
+	dg_core_cell_set_threaded(c, !fn);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -122,11 +131,13 @@ dg_base_indicator_set_critical(dg_core_cell_t *c, unsigned int blink_multiplier)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_INDICATOR);
 	
+	dg_core_cell_lock(c);
 	_PROPS->anim_multi = blink_multiplier;
 	if (_PROPS->state != _CRIT_HIGH && _PROPS->state != _CRIT_LOW) {
 		_PROPS->state = _CRIT_HIGH;
-		_PROPS->anim_count = 0;
+		_PROPS->anim_next = 0;
 	}
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -139,7 +150,9 @@ dg_base_indicator_set_label(dg_core_cell_t *c, const char *str)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_INDICATOR);
 	
+	dg_core_cell_lock(c);
 	dg_base_string_set(&_PROPS->label, str);
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -152,7 +165,9 @@ dg_base_indicator_set_label_origin(dg_core_cell_t *c, dg_base_origin_t og)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_INDICATOR);
 	
+	dg_core_cell_lock(c);
 	_PROPS->label_og = og;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -165,7 +180,9 @@ dg_base_indicator_set_off(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_INDICATOR);
 	
+	dg_core_cell_lock(c);
 	_PROPS->state = _OFF;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -178,7 +195,9 @@ dg_base_indicator_set_on(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_INDICATOR);
 	
+	dg_core_cell_lock(c);
 	_PROPS->state = _ON;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -195,17 +214,34 @@ _animate(dg_core_cell_t *c, dg_core_cell_drawing_context_t *dc)
 	}
 
 	const bool high = _PROPS->state == _CRIT_HIGH;
+	const unsigned long now = dg_core_util_get_time();
 
-	_PROPS->anim_count += dc->delay;
-	if (_PROPS->anim_count >= _STYLE->anim_speed * 1000 / _PROPS->anim_multi) {
-		_PROPS->anim_count = 0;
+	if (_PROPS->anim_next > 0 && now >= _PROPS->anim_next) {
 		_PROPS->state = high ? _CRIT_LOW : _CRIT_HIGH;
 		if (_PROPS->fn_blink) {
 			_PROPS->fn_blink(c, high);
 		}
 	}
-	
-	dc->msg |= DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE;
+
+	/* blinks are aligned on multiples of their period, so that indicators sharing a cadence blink together */
+	/* and the window only wakes up once for all of them                                                    */
+
+	const unsigned long period = _STYLE->anim_speed * 1000 / _PROPS->anim_multi;
+
+	if (_PROPS->anim_next == 0 || now >= _PROPS->anim_next) {
+		_PROPS->anim_next = period > 0 ? (now / period + 1) * period : now;
+	}
+
+	/* only the foreground blinks, the label is drawn on top of it */
+
+	const dg_base_zone_t zf = dg_base_zone_get_foreground(dc, _STYLE);
+
+	dc->msg        |= DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE_AT;
+	dc->update_time = _PROPS->anim_next;
+	dc->update_px   = zf.px - dc->cell_px;
+	dc->update_py   = zf.py - dc->cell_py;
+	dc->update_pw   = zf.pw;
+	dc->update_ph   = zf.ph;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
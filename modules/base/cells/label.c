@@ -105,6 +105,9 @@ dg_base_label_create(void)
 	props->label_rot = DG_BASE_ROTATION_NORMAL;
 	props->label_cl  = DG_BASE_CONFIG_COLOR_DEFAULT;
 
+	dg_core_cell_set_retained(c, true);
+	dg_core_cell_set_threaded(c, true);
+
 	return c;
 }
 
@@ -116,7 +119,9 @@ dg_base_label_set_color(dg_core_cell_t *c, dg_base_config_color_t cl)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_LABEL);
 
+	dg_core_cell_lock(c);
 	_PROPS->label_cl = cl;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -129,7 +134,9 @@ dg_base_label_set_label(dg_core_cell_t *c, const char *str)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_LABEL);
 
+	dg_core_cell_lock(c);
 	dg_base_string_set(&_PROPS->label, str);
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -142,7 +149,9 @@ dg_base_label_set_origin(dg_core_cell_t *c, dg_base_origin_t og)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_LABEL);
 
+	dg_core_cell_lock(c);
 	_PROPS->label_og = og;
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -155,7 +164,9 @@ dg_base_label_set_rotation(dg_core_cell_t *c, dg_base_rotation_t rot)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_LABEL);
 
+	dg_core_cell_lock(c);
 	_PROPS->label_rot = rot;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -51,7 +51,14 @@ dg_base_placeholder_create(void)
 
 	const unsigned int serial = dg_base_get_type_serial(DG_BASE_PLACEHOLDER);
 
-	return dg_core_cell_create(serial, _draw, NULL, NULL, NULL);
+	dg_core_cell_t *c = dg_core_cell_create(serial, _draw, NULL, NULL, NULL);
+	if (!c) {
+		return NULL;
+	}
+
+	dg_core_cell_set_threaded(c, true);
+
+	return c;
 }
 
 /************************************************************************************************************/
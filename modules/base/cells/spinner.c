@@ -86,6 +86,8 @@ dg_base_spinner_create(void)
 	props->angle    = 0.0;
 	props->spinning = true;
 
+	dg_core_cell_set_threaded(c, true);
+
 	return c;
 }
 
@@ -97,7 +99,9 @@ dg_base_spinner_pause(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SPINNER);
 
+	dg_core_cell_lock(c);
 	_PROPS->spinning = false;
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -110,7 +114,9 @@ dg_base_spinner_play(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SPINNER);
 
+	dg_core_cell_lock(c);
 	_PROPS->spinning = false;
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -123,7 +129,9 @@ dg_base_spinner_set_label(dg_core_cell_t *c, const char *str)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SPINNER);
 
+	dg_core_cell_lock(c);
 	dg_base_string_set(&_PROPS->label, str);
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -136,7 +144,9 @@ dg_base_spinner_set_label_origin(dg_core_cell_t *c, dg_base_origin_t og)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SPINNER);
 	
+	dg_core_cell_lock(c);
 	_PROPS->label_og = og;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -149,7 +159,9 @@ dg_base_spinner_toggle(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SPINNER);
 
+	dg_core_cell_lock(c);
 	_PROPS->spinning = !_PROPS->spinning;
+	dg_core_cell_unlock(c);
 
 	dg_core_cell_redraw(c);
 }
@@ -168,7 +180,17 @@ _animate(dg_core_cell_t *c, dg_core_cell_drawing_context_t *dc)
 	_PROPS->angle += _STYLE->anim_speed / 1000000.0 * dc->delay;
 	fmod(_PROPS->angle, DG_BASE_DRAW_PI * 2);
 
-	dc->msg |= DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE;
+	/* only the icon moves, its strokes may overflow its zone by their thickness */
+
+	dg_base_zone_t zi = dg_base_zone_get_icon(dc, _STYLE);
+
+	dg_base_zone_pad(&zi, -_STYLE->thick_icon);
+
+	dc->msg      |= DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE_REGION;
+	dc->update_px = zi.px - dc->cell_px;
+	dc->update_py = zi.py - dc->cell_py;
+	dc->update_pw = zi.pw;
+	dc->update_ph = zi.ph;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
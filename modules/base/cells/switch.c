@@ -100,6 +100,8 @@ dg_base_switch_create(void)
 	props->fn_press = NULL;
 	props->on       = false;
 
+	dg_core_cell_set_threaded(c, true);
+
 	return c;
 }
 
@@ -122,7 +124,9 @@ dg_base_switch_set_callback_pressed(dg_core_cell_t *c, void (*fn)(dg_core_cell_t
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SWITCH);
 
+	dg_core_cell_lock(c);
 	_PROPS->fn_press = fn;
+	dg_core_cell_unlock(c);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -133,7 +137,9 @@ dg_base_switch_set_label(dg_core_cell_t *c, const char *str)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SWITCH);
 	
+	dg_core_cell_lock(c);
 	dg_base_string_set(&_PROPS->label, str);
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -146,7 +152,9 @@ dg_base_switch_set_label_origin(dg_core_cell_t *c, dg_base_origin_t og)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SWITCH);
 	
+	dg_core_cell_lock(c);
 	_PROPS->label_og = og;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -159,7 +167,9 @@ dg_base_switch_set_off(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SWITCH);
 
+	dg_core_cell_lock(c);
 	_PROPS->on = false;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -172,7 +182,9 @@ dg_base_switch_set_on(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SWITCH);
 
+	dg_core_cell_lock(c);
 	_PROPS->on = true;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -185,7 +197,9 @@ dg_base_switch_toggle(dg_core_cell_t *c)
 	DG_BASE_IS_INIT;
 	DG_BASE_IS_CELL(c, DG_BASE_SWITCH);
 
+	dg_core_cell_lock(c);
 	_PROPS->on = !_PROPS->on;
+	dg_core_cell_unlock(c);
 	
 	dg_core_cell_redraw(c);
 }
@@ -30,8 +30,10 @@
 #include <dg/core/core.h>
 #include <dg/core/errno.h>
 
+#include "atlas-private.h"
 #include "config.h"
 #include "draw.h"
+#include "fill-private.h"
 #include "origin.h"
 #include "rotation.h"
 #include "string.h"
@@ -43,6 +45,11 @@
 
 #define _IS_ZONE_VALID(Z) {assert(z && z->c_ctx); if (Z->pw <= 0 || Z->ph <= 0) { return; }}
 
+#define _GLYPHS_STACK_N 128
+
+#define _BATCH_BOXES  256
+#define _BATCH_COLORS 16
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 typedef struct {
@@ -50,18 +57,62 @@ typedef struct {
 	bool right;
 } _lim_sides_t;
 
+/**
+ * Axis-aligned rectangle in device space.
+ */
+typedef struct {
+	double x1;
+	double y1;
+	double x2;
+	double y2;
+} _box_t;
+
+/**
+ * Rectangles waiting to be drawn, grouped by color. Overlapping rectangles of different colors never coexist
+ * in a batch, so the order in which the colors get drawn does not matter.
+ *
+ * @param c_ctx    : context the batch is open on, NULL if there is no open batch
+ * @param cl       : colors used by pending boxes
+ * @param px       : same colors, packed as premultiplied ARGB32 pixels for direct image surface writes
+ * @param bounds   : bounding box of all the pending boxes of each color
+ * @param n_cl     : number of colors
+ * @param boxes    : pending boxes
+ * @param boxes_cl : color index of each pending box
+ * @param n_boxes  : number of pending boxes
+ */
+typedef struct {
+	cairo_t *c_ctx;
+	dg_core_color_t cl[_BATCH_COLORS];
+	uint32_t px[_BATCH_COLORS];
+	_box_t bounds[_BATCH_COLORS];
+	size_t n_cl;
+	_box_t boxes[_BATCH_BOXES];
+	size_t boxes_cl[_BATCH_BOXES];
+	size_t n_boxes;
+} _batch_t;
+
 /************************************************************************************************************/
 /************************************************************************************************************/
 /************************************************************************************************************/
 
-static void _draw_text_row    (dg_base_zone_t *z, int16_t px, int16_t py, const char *str, size_t str_n, dg_base_origin_t og);
+static void _batch_sync       (dg_base_zone_t *z);
+static void _draw_glyph_row   (dg_base_zone_t *z, int16_t px, int16_t py, const unsigned long *ids, size_t ids_n, cairo_glyph_t *buf, bool bold, dg_base_origin_t og);
+static void _draw_glyphs      (dg_base_zone_t *z, int16_t px, cairo_glyph_t *glyphs, int glyphs_n, bool bold, dg_base_origin_t og);
+static void _draw_rect        (dg_base_zone_t *z, dg_core_color_t cl, double x, double y, double w, double h);
+static void _draw_text_row    (dg_base_zone_t *z, int16_t px, int16_t py, const char *str, size_t str_n, bool bold, dg_base_origin_t og);
 static void _matrix_normalize (dg_base_zone_t *z);
 static void _matrix_restore   (dg_base_zone_t *z, cairo_matrix_t *c_mat);
 static void _matrix_rotate    (dg_base_zone_t *z, dg_base_rotation_t rot, double x, double y);
 static void _set_antialias    (dg_base_zone_t *z, bool ena);
 
+static const unsigned long *_glyphs_get (dg_base_zone_t *z, const dg_base_string_t *str, bool bold);
+
 static cairo_matrix_t _matrix_get (dg_base_zone_t *z);
 
+static size_t _batch_find_color (dg_core_color_t cl);
+static bool   _batch_overlaps   (const _box_t *b, size_t i_cl);
+static bool   _box_overlaps     (const _box_t *b1, const _box_t *b2);
+
 /************************************************************************************************************/
 /************************************************************************************************************/
 /************************************************************************************************************/
@@ -78,6 +129,8 @@ static const _lim_sides_t _lim_sides[9] = {
 	{1, 0}, /* BOTTOM RIGHT */
 };
 
+static _Thread_local _batch_t _batch = {0};
+
 /************************************************************************************************************/
 /* PUBLIC ***************************************************************************************************/
 /************************************************************************************************************/
@@ -87,6 +140,7 @@ dg_base_draw_arc(dg_base_zone_t *z, dg_core_color_t cl, double x, double y, doub
                  int16_t thickness)
 {
 	_IS_ZONE_VALID(z);
+	_batch_sync(z);
 
 	cairo_matrix_t c_mat = _matrix_get(z);
 
@@ -102,10 +156,88 @@ dg_base_draw_arc(dg_base_zone_t *z, dg_core_color_t cl, double x, double y, doub
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+void
+dg_base_draw_batch_begin(cairo_t *c_ctx)
+{
+	assert(c_ctx);
+
+	if (_batch.c_ctx != c_ctx) {
+		dg_base_draw_batch_end();
+	}
+
+	_batch.c_ctx = c_ctx;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_base_draw_batch_end(void)
+{
+	dg_base_draw_batch_flush();
+
+	_batch.c_ctx = NULL;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_base_draw_batch_flush(void)
+{
+	if (_batch.n_boxes == 0) {
+		return;
+	}
+
+	/* boxes are already in device space */
+
+	cairo_t *c_ctx = _batch.c_ctx;
+	const _box_t *b;
+	dg_base_fill_t fill;
+	bool fast;
+	bool pending;
+
+	cairo_save(c_ctx);
+	cairo_identity_matrix(c_ctx);
+	cairo_set_antialias(c_ctx, CAIRO_ANTIALIAS_NONE);
+
+	/* on image surfaces, boxes are written straight into the pixel buffer when possible */
+
+	fast = dg_base_fill_begin(c_ctx, &fill);
+
+	for (size_t i = 0; i < _batch.n_cl; i++) {
+		pending = false;
+		for (size_t j = 0; j < _batch.n_boxes; j++) {
+			if (_batch.boxes_cl[j] != i) {
+				continue;
+			}
+			b = _batch.boxes + j;
+			if (!fast || !dg_base_fill_box(&fill, b->x1, b->y1, b->x2, b->y2, _batch.cl[i], _batch.px[i])) {
+				cairo_rectangle(c_ctx, b->x1, b->y1, b->x2 - b->x1, b->y2 - b->y1);
+				pending = true;
+			}
+		}
+		if (pending) {
+			cairo_set_source_rgba(c_ctx, _batch.cl[i].r, _batch.cl[i].g, _batch.cl[i].b, _batch.cl[i].a);
+			cairo_fill(c_ctx);
+		}
+	}
+
+	if (fast) {
+		dg_base_fill_end(&fill);
+	}
+
+	cairo_restore(c_ctx);
+
+	_batch.n_cl    = 0;
+	_batch.n_boxes = 0;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 void
 dg_base_draw_circle(dg_base_zone_t *z, dg_core_color_t cl, double x, double y, double r, int16_t thickness)
 {
 	_IS_ZONE_VALID(z);
+	_batch_sync(z);
 
 	cairo_matrix_t c_mat = _matrix_get(z);
 
@@ -133,13 +265,15 @@ dg_base_draw_body(dg_base_zone_t *z, const dg_base_config_style_t *style)
 
 	assert(style);
 
+	/* layers are drawn as non-overlapping rings so that they can be batched together */
+
 	if (style->margin > 0) {
 		dg_base_zone_pad(z, -style->margin);
-		dg_base_draw_fill(z, DG_CORE_CONFIG->win_cl_bg);
+		dg_base_draw_contour(z, DG_CORE_CONFIG->win_cl_bg, style->margin);
 		dg_base_zone_pad(z, style->margin);
 	}
 
-	dg_base_draw_fill(z, style->cl_bd);
+	dg_base_draw_contour(z, style->cl_bd, style->thick_bd);
 	dg_base_zone_pad(z, style->thick_bd);
 	dg_base_draw_fill(z, style->cl_bg);
 	dg_base_zone_pad (z, -style->thick_bd);
@@ -152,12 +286,37 @@ dg_base_draw_contour(dg_base_zone_t *z, dg_core_color_t cl, int16_t thickness)
 {
 	_IS_ZONE_VALID(z);
 
-	cairo_set_source_rgba(z->c_ctx, cl.r, cl.g, cl.b, cl.a);
-	cairo_rectangle(z->c_ctx, z->px,         z->py,               z->pw,             thickness);
-	cairo_rectangle(z->c_ctx, z->px,         z->py + z->ph,       z->pw,           - thickness);
-	cairo_rectangle(z->c_ctx, z->px,         z->py + thickness,   thickness, z->ph - thickness * 2);
-	cairo_rectangle(z->c_ctx, z->px + z->pw, z->py + thickness, - thickness, z->ph - thickness * 2);
-	cairo_fill(z->c_ctx);
+	/* get the outer bounds of the contour */
+
+	int16_t x = z->px;
+	int16_t y = z->py;
+	int16_t w = z->pw;
+	int16_t h = z->ph;
+	int16_t t = thickness;
+
+	if (t < 0) {
+		x += t;
+		y += t;
+		w -= t * 2;
+		h -= t * 2;
+		t  = -t;
+	}
+
+	/* draw sides, or everything if they would meet */
+
+	if (t == 0) {
+		return;
+	}
+
+	if (t * 2 >= w || t * 2 >= h) {
+		_draw_rect(z, cl, x, y, w, h);
+		return;
+	}
+
+	_draw_rect(z, cl, x,         y,         w, t);
+	_draw_rect(z, cl, x,         y + h - t, w, t);
+	_draw_rect(z, cl, x,         y + t,     t, h - t * 2);
+	_draw_rect(z, cl, x + w - t, y + t,     t, h - t * 2);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -167,9 +326,7 @@ dg_base_draw_fill(dg_base_zone_t *z, dg_core_color_t cl)
 {
 	_IS_ZONE_VALID(z);
 
-	cairo_rectangle(z->c_ctx, z->px, z->py, z->pw, z->ph);
-	cairo_set_source_rgba(z->c_ctx, cl.r, cl.g, cl.b, cl.a);
-	cairo_fill(z->c_ctx);
+	_draw_rect(z, cl, z->px, z->py, z->pw, z->ph);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -238,19 +395,16 @@ dg_base_draw_label(dg_base_zone_t *z, const dg_base_config_style_t *style, const
 	}
 
 	if (_lim_sides[og].left) {
-		cairo_rectangle(z->c_ctx, z->px, z->py, style->thick_lim, z->ph);
+		_draw_rect(z, style->cl_lim, z->px, z->py, style->thick_lim, z->ph);
 		z->px += style->thick_lim + style->gap_lim;
 		z->pw -= style->thick_lim + style->gap_lim;
 	}
 
 	if (_lim_sides[og].right) {
-		cairo_rectangle(z->c_ctx, z->px + z->pw, z->py, -style->thick_lim, z->ph);
+		_draw_rect(z, style->cl_lim, z->px + z->pw, z->py, -style->thick_lim, z->ph);
 		z->pw -= style->thick_lim + style->gap_lim;
 	}
 
-	cairo_set_source_rgba(z->c_ctx, style->cl_lim.r, style->cl_lim.g, style->cl_lim.b, style->cl_lim.a);
-	cairo_fill(z->c_ctx);
-
 skip_lim:
 
 	/* draw label */
@@ -277,6 +431,7 @@ dg_base_draw_lines(dg_base_zone_t *z, dg_core_color_t cl, const dg_base_draw_poi
                    int16_t thickness)
 {
 	_IS_ZONE_VALID(z);
+	_batch_sync(z);
 
 	assert(points);
 
@@ -308,22 +463,26 @@ dg_base_draw_rectangle(dg_base_zone_t *z, dg_core_color_t cl, double x1, double
                        int16_t thickness)
 {
 	_IS_ZONE_VALID(z);
+	_batch_sync(z);
 
 	cairo_matrix_t c_mat = _matrix_get(z);
 
 	_set_antialias(z, false);
+
+	if (thickness <= 0) {
+		_matrix_normalize(z);
+			_draw_rect(z, cl, x1, y1, x2 - x1, y2 - y1);
+		_matrix_restore(z, &c_mat);
+		return;
+	}
+
 	_matrix_normalize(z);
 		cairo_rectangle(z->c_ctx, x1, y1, x2 - x1, y2 - y1);
 	_matrix_restore(z, &c_mat);
 
 	cairo_set_source_rgba(z->c_ctx, cl.r, cl.g, cl.b, cl.a);
-
-	if (thickness > 0) {
-		cairo_set_line_width(z->c_ctx, thickness);
-		cairo_stroke(z->c_ctx);
-	} else {
-		cairo_fill(z->c_ctx);
-	}
+	cairo_set_line_width(z->c_ctx, thickness);
+	cairo_stroke(z->c_ctx);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -333,6 +492,7 @@ dg_base_draw_segment(dg_base_zone_t *z, dg_core_color_t cl, double x1, double y1
                      int16_t thickness)
 {
 	_IS_ZONE_VALID(z);
+	_batch_sync(z);
 
 	cairo_matrix_t c_mat = _matrix_get(z);
 
@@ -369,9 +529,7 @@ dg_base_draw_separator(dg_base_zone_t *z, const dg_base_config_style_t *style, i
 
 	_set_antialias(z, false);
 	_matrix_rotate(z, rot, px, py);
-		cairo_rectangle(z->c_ctx, x, y, style->thick_sep, length);	
-		cairo_set_source_rgba(z->c_ctx, cl.r, cl.g, cl.b, cl.a);
-		cairo_fill(z->c_ctx);
+		_draw_rect(z, cl, x, y, style->thick_sep, length);
 	_matrix_restore(z, &c_mat);
 }
 
@@ -388,6 +546,8 @@ void dg_base_draw_string(dg_base_zone_t *z, dg_core_color_t cl, const dg_base_st
 		return;
 	}
 
+	_batch_sync(z);
+
 	int16_t offset = DG_CORE_CONFIG->ft_ascent;
 
 	/* calc initial vertical offset */
@@ -420,11 +580,28 @@ void dg_base_draw_string(dg_base_zone_t *z, dg_core_color_t cl, const dg_base_st
 	dg_base_zone_apply_core_font(z, bold);
 	_matrix_rotate(z, rot, px, py);
 
+	/* with cached glyph indices rows only need their glyph positions to be filled in */
+
+	cairo_glyph_t  buf_stack[_GLYPHS_STACK_N];
+	cairo_glyph_t *buf = buf_stack;
+
+	const unsigned long *ids = _glyphs_get(z, str, bold);
+
+	if (ids && str->n_cols > _GLYPHS_STACK_N) {
+		buf = malloc(str->n_cols * sizeof(cairo_glyph_t));
+		if (!buf) {
+			dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+			ids = NULL;
+		}
+	}
+
 	/* draw rows */
 
 	const char *s = str->chars;
 	bool end = false;
 	size_t n = 0;
+	size_t k = 0;
+	size_t k_row = 0;
 
 	for (size_t i = 0; !end; i++) {
 		switch (str->chars[i]) {
@@ -434,20 +611,32 @@ void dg_base_draw_string(dg_base_zone_t *z, dg_core_color_t cl, const dg_base_st
 				/* fallthrough */
 
 			case '\n':
-				_draw_text_row(z, px, py + offset, s, n, og);
+				if (ids) {
+					_draw_glyph_row(z, px, py + offset, ids + k_row, k - k_row, buf, bold, og);
+				} else {
+					_draw_text_row(z, px, py + offset, s, n, bold, og);
+				}
 				offset += DG_CORE_CONFIG->ft_ph + DG_CORE_CONFIG->ft_spacing_h;
 				s = str->chars + i + 1;
 				n = 0;
+				k_row = ++k;
 				break;
 
 			default:
+				if (((uint8_t)str->chars[i] >> 6) != 0x02) { /* bitmask = 10xxxxxx */
+					k++;
+				}
 				n++;
 				break;
 		}
 	}
 
 	/* end */
-		
+
+	if (buf != buf_stack) {
+		free(buf);
+	}
+
 	_matrix_restore(z, &c_mat);
 }
 
@@ -458,6 +647,7 @@ dg_base_draw_triangle(dg_base_zone_t *z, dg_core_color_t cl, double x1, double y
                       double x3, double y3, int16_t thickness)
 {
 	_IS_ZONE_VALID(z);
+	_batch_sync(z);
 
 	cairo_matrix_t c_mat = _matrix_get(z);
 
@@ -483,26 +673,79 @@ dg_base_draw_triangle(dg_base_zone_t *z, dg_core_color_t cl, double x1, double y
 /* _ ********************************************************************************************************/
 /************************************************************************************************************/
 
+static size_t
+_batch_find_color(dg_core_color_t cl)
+{
+	for (size_t i = 0; i < _batch.n_cl; i++) {
+		if (_batch.cl[i].r == cl.r && _batch.cl[i].g == cl.g && _batch.cl[i].b == cl.b && _batch.cl[i].a == cl.a) {
+			return i;
+		}
+	}
+
+	return _batch.n_cl;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_batch_overlaps(const _box_t *b, size_t i_cl)
+{
+	for (size_t i = 0; i < _batch.n_cl; i++) {
+		if (i == i_cl || !_box_overlaps(b, _batch.bounds + i)) {
+			continue;
+		}
+		for (size_t j = 0; j < _batch.n_boxes; j++) {
+			if (_batch.boxes_cl[j] == i && _box_overlaps(b, _batch.boxes + j)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static void
-_draw_text_row(dg_base_zone_t *z, int16_t px, int16_t py, const char *str, size_t str_n, dg_base_origin_t og)
+_batch_sync(dg_base_zone_t *z)
 {
-	int16_t offset = 0;
+	if (z->c_ctx == _batch.c_ctx) {
+		dg_base_draw_batch_flush();
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_box_overlaps(const _box_t *b1, const _box_t *b2)
+{
+	return b1->x1 < b2->x2 && b2->x1 < b1->x2 && b1->y1 < b2->y2 && b2->y1 < b1->y2;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static void
+_draw_glyph_row(dg_base_zone_t *z, int16_t px, int16_t py, const unsigned long *ids, size_t ids_n,
+                cairo_glyph_t *buf, bool bold, dg_base_origin_t og)
+{
 	px += z->px;
 	py += z->py;
 
-	/* get glyph array */
+	for (size_t i = 0; i < ids_n; i++) {
+		buf[i].index = ids[i];
+		buf[i].y     = py;
+	}
 
-	int glyphs_n = 0;
-	cairo_glyph_t *glyphs = NULL;
-	cairo_scaled_font_t *c_sft = cairo_get_scaled_font(z->c_ctx);
-	cairo_status_t status;
+	_draw_glyphs(z, px, buf, ids_n, bold, og);
+}
 
-	status = cairo_scaled_font_text_to_glyphs(c_sft, px, py, str, str_n, &glyphs, &glyphs_n, NULL, NULL, NULL);
-	if (status != CAIRO_STATUS_SUCCESS) {
-		dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
-		return;
-	}
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_draw_glyphs(dg_base_zone_t *z, int16_t px, cairo_glyph_t *glyphs, int glyphs_n, bool bold,
+             dg_base_origin_t og)
+{
+	int16_t offset = 0;
 
 	/* calc initial horizontal offset */
 
@@ -536,12 +779,168 @@ _draw_text_row(dg_base_zone_t *z, int16_t px, int16_t py, const char *str, size_
 
 	/* draw */
 
+	if (DG_CORE_CONFIG->ft_backend == DG_CORE_CONFIG_FONT_ATLAS &&
+	    dg_base_atlas_show_glyphs(z->c_ctx, glyphs, glyphs_n, bold)) {
+		return;
+	}
+
 	cairo_show_glyphs(z->c_ctx, glyphs, glyphs_n);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_draw_rect(dg_base_zone_t *z, dg_core_color_t cl, double x, double y, double w, double h)
+{
+	cairo_matrix_t c_mat = _matrix_get(z);
+
+	const bool aligned = (c_mat.xy == 0.0 && c_mat.yx == 0.0) || (c_mat.xx == 0.0 && c_mat.yy == 0.0);
+
+	/* draw right away when not batching or if the rectangle is not axis-aligned once transformed */
+
+	if (z->c_ctx != _batch.c_ctx || !aligned) {
+		_batch_sync(z);
+		cairo_rectangle(z->c_ctx, x, y, w, h);
+		cairo_set_source_rgba(z->c_ctx, cl.r, cl.g, cl.b, cl.a);
+		cairo_fill(z->c_ctx);
+		return;
+	}
+
+	/* get device space box */
+
+	double x1 = x;
+	double y1 = y;
+	double x2 = x + w;
+	double y2 = y + h;
+
+	cairo_user_to_device(z->c_ctx, &x1, &y1);
+	cairo_user_to_device(z->c_ctx, &x2, &y2);
+
+	const _box_t b = {
+		.x1 = x1 < x2 ? x1 : x2,
+		.y1 = y1 < y2 ? y1 : y2,
+		.x2 = x1 < x2 ? x2 : x1,
+		.y2 = y1 < y2 ? y2 : y1,
+	};
+
+	if (b.x1 == b.x2 || b.y1 == b.y2) {
+		return;
+	}
+
+	/* draw what's pending first if the box can't join the batch as is */
+
+	size_t i_cl = _batch_find_color(cl);
+
+	if (_batch.n_boxes == _BATCH_BOXES || i_cl == _BATCH_COLORS || _batch_overlaps(&b, i_cl)) {
+		dg_base_draw_batch_flush();
+		i_cl = 0;
+	}
+
+	/* add box */
+
+	if (i_cl == _batch.n_cl) {
+		_batch.cl[i_cl]     = cl;
+		_batch.px[i_cl]     = dg_core_color_to_argb32(cl);
+		_batch.bounds[i_cl] = b;
+		_batch.n_cl++;
+	} else {
+		_batch.bounds[i_cl].x1 = b.x1 < _batch.bounds[i_cl].x1 ? b.x1 : _batch.bounds[i_cl].x1;
+		_batch.bounds[i_cl].y1 = b.y1 < _batch.bounds[i_cl].y1 ? b.y1 : _batch.bounds[i_cl].y1;
+		_batch.bounds[i_cl].x2 = b.x2 > _batch.bounds[i_cl].x2 ? b.x2 : _batch.bounds[i_cl].x2;
+		_batch.bounds[i_cl].y2 = b.y2 > _batch.bounds[i_cl].y2 ? b.y2 : _batch.bounds[i_cl].y2;
+	}
+
+	_batch.boxes[_batch.n_boxes]    = b;
+	_batch.boxes_cl[_batch.n_boxes] = i_cl;
+	_batch.n_boxes++;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_draw_text_row(dg_base_zone_t *z, int16_t px, int16_t py, const char *str, size_t str_n, bool bold,
+               dg_base_origin_t og)
+{
+	px += z->px;
+	py += z->py;
+
+	/* get glyph array */
+
+	int glyphs_n = 0;
+	cairo_glyph_t *glyphs = NULL;
+	cairo_scaled_font_t *c_sft = cairo_get_scaled_font(z->c_ctx);
+	cairo_status_t status;
+
+	status = cairo_scaled_font_text_to_glyphs(c_sft, px, py, str, str_n, &glyphs, &glyphs_n, NULL, NULL, NULL);
+	if (status != CAIRO_STATUS_SUCCESS) {
+		dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
+		return;
+	}
+
+	_draw_glyphs(z, px, glyphs, glyphs_n, bold, og);
 	cairo_glyph_free(glyphs);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static const unsigned long *
+_glyphs_get(dg_base_zone_t *z, const dg_base_string_t *str, bool bold)
+{
+	/* the glyph cache is not part of the string's contents, so it gets filled in even through a const string */
+
+	dg_base_string_t *s = (dg_base_string_t*)str;
+	const size_t v = bold ? 1 : 0;
+
+	if (s->glyphs[v] && s->glyphs_gen[v] == DG_CORE_CONFIG->ft_generation) {
+		return s->glyphs[v];
+	}
+
+	free(s->glyphs[v]);
+	s->glyphs[v]     = NULL;
+	s->glyphs_gen[v] = 0;
+
+	/* convert the whole string at once, newlines included */
+
+	int glyphs_n = 0;
+	cairo_glyph_t *glyphs = NULL;
+	cairo_scaled_font_t *c_sft = cairo_get_scaled_font(z->c_ctx);
+	cairo_status_t status;
+
+	status = cairo_scaled_font_text_to_glyphs(c_sft, 0, 0, s->chars, -1, &glyphs, &glyphs_n, NULL, NULL, NULL);
+	if (status != CAIRO_STATUS_SUCCESS) {
+		dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
+		return NULL;
+	}
+
+	/* rows can only be split back from the indices if each codepoint maps to exactly one glyph */
+	/* the extra slot matches the string's null terminator codepoint                             */
+
+	if ((size_t)glyphs_n + 1 != s->n_codepoints) {
+		goto skip;
+	}
+
+	s->glyphs[v] = malloc(s->n_codepoints * sizeof(unsigned long));
+	if (!s->glyphs[v]) {
+		dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+		goto skip;
+	}
+
+	for (int i = 0; i < glyphs_n; i++) {
+		s->glyphs[v][i] = glyphs[i].index;
+	}
+
+	s->glyphs[v][glyphs_n] = 0;
+	s->glyphs_gen[v] = DG_CORE_CONFIG->ft_generation;
+
+skip:
+
+	cairo_glyph_free(glyphs);
+
+	return s->glyphs[v];
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static cairo_matrix_t
 _matrix_get(dg_base_zone_t *z)
 {
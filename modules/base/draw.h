@@ -59,6 +59,33 @@ typedef struct {
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+/**
+ * Opens a drawing batch on a cairo context. While it is open, the axis-aligned rectangles drawn on that
+ * context by dg_base_draw_body(), dg_base_draw_contour(), dg_base_draw_fill(), dg_base_draw_separator(),
+ * filled dg_base_draw_rectangle() calls and label limits are not drawn right away. They are collected by
+ * color instead, to be drawn later with a single fill per color. Rectangles that overlap pending ones of
+ * another color, and all the other drawing functions of this module, draw the pending rectangles first so
+ * that the drawing order is preserved. If a batch is already open on another context, it gets closed first.
+ * The core opens a batch around the drawing of cells of each window frame once this module is initialised,
+ * therefore cells that draw on their context directly with cairo have to call dg_base_draw_batch_flush()
+ * beforehand.
+ *
+ * @param c_ctx : cairo context to batch drawing operations of
+ */
+void dg_base_draw_batch_begin(cairo_t *c_ctx);
+
+/**
+ * Draws the pending rectangles and closes the current drawing batch, if any.
+ */
+void dg_base_draw_batch_end(void);
+
+/**
+ * Draws the pending rectangles of the current drawing batch, if any, without closing it.
+ */
+void dg_base_draw_batch_flush(void);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 /**
  * Draws a cell's background, border in the given zone following the given style.
  * Its expected that the zone is obtained directly from dg_base_zone_get_from_context().
@@ -0,0 +1,107 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#ifndef DG_BASE_FILL_H_PRIVATE
+#define DG_BASE_FILL_H_PRIVATE
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <cairo/cairo.h>
+
+#include <dg/core/color.h>
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+/**
+ * Pixel buffer of an image surface that solid rectangles get written into directly, bypassing cairo.
+ *
+ * @param c_srf  : image surface that owns the pixel buffer
+ * @param c_clip : clip of the context the fills were started on, as device space rectangles
+ * @param data   : first pixel of the buffer
+ * @param stride : number of pixels between the starts of two consecutive rows
+ * @param pw     : pixel width  of the surface
+ * @param ph     : pixel height of the surface
+ * @param off_x  : horizontal device offset of the surface
+ * @param off_y  : vertical   device offset of the surface
+ * @param op     : compositing operator of the context
+ * @param dirty  : pixels were written since the fills were started
+ */
+typedef struct {
+	cairo_surface_t *c_srf;
+	cairo_rectangle_list_t *c_clip;
+	uint32_t *data;
+	size_t stride;
+	int pw;
+	int ph;
+	double off_x;
+	double off_y;
+	cairo_operator_t op;
+	bool dirty;
+} dg_base_fill_t;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Prepares direct pixel writes on the current target of a cairo context. This is only possible when the
+ * target is an ARGB32 or RGB24 image surface and the context's clip can be represented as a list of
+ * rectangles. The context's transformation matrix must be the identity, so that the user space coordinates
+ * given to dg_base_fill_box() are device space coordinates. The fastest span kernel supported by the CPU
+ * (AVX2, SSE2, NEON or plain C) is picked on the first call.
+ *
+ * @param c_ctx : cairo context to draw to
+ * @param fill  : fill state to set up, left untouched if false is returned
+ *
+ * @return : true if direct writes are possible, false otherwhise
+ */
+bool dg_base_fill_begin(cairo_t *c_ctx, dg_base_fill_t *fill);
+
+/**
+ * Fills a device space rectangle with a solid color by writing pixels straight into the surface's buffer.
+ * The rectangle is clipped against the context's clip and the surface's bounds. Only pixel-aligned
+ * rectangles drawn with the SOURCE operator or with an opaque (or fully transparent) color and the OVER
+ * operator are handled, anything else is left to cairo.
+ *
+ * @param fill : fill state set up by dg_base_fill_begin()
+ * @param x1   : left   edge of the rectangle
+ * @param y1   : top    edge of the rectangle
+ * @param x2   : right  edge of the rectangle
+ * @param y2   : bottom edge of the rectangle
+ * @param cl   : color of the rectangle
+ * @param px   : same color, packed with dg_core_color_to_argb32()
+ *
+ * @return : true if the rectangle was handled, false if it has to be drawn with cairo instead
+ */
+bool dg_base_fill_box(dg_base_fill_t *fill, double x1, double y1, double x2, double y2, dg_core_color_t cl, uint32_t px);
+
+/**
+ * Tells cairo about the written pixels and frees the fill state's resources.
+ *
+ * @param fill : fill state set up by dg_base_fill_begin()
+ */
+void dg_base_fill_end(dg_base_fill_t *fill);
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#endif /* DG_BASE_FILL_H_PRIVATE */
@@ -0,0 +1,330 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#include <math.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cairo/cairo.h>
+
+#include <dg/core/color.h>
+
+#include "fill-private.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	#include <immintrin.h>
+	#define _HAS_AVX2
+	#ifdef __SSE2__
+		#define _HAS_SSE2
+	#endif
+#elif defined(__ARM_NEON)
+	#include <arm_neon.h>
+	#define _HAS_NEON
+#endif
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+/**
+ * Writes the same pixel n times in a row.
+ */
+typedef void (*_span_fn_t)(uint32_t *dst, size_t n, uint32_t px);
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+static void _span_scalar (uint32_t *dst, size_t n, uint32_t px);
+
+#ifdef _HAS_AVX2
+static void _span_avx2 (uint32_t *dst, size_t n, uint32_t px);
+#endif
+
+#ifdef _HAS_SSE2
+static void _span_sse2 (uint32_t *dst, size_t n, uint32_t px);
+#endif
+
+#ifdef _HAS_NEON
+static void _span_neon (uint32_t *dst, size_t n, uint32_t px);
+#endif
+
+static void _span_pick (void);
+
+static bool _is_pixel_aligned (double v);
+
+static int _clamp (double v, int max);
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+static _span_fn_t _span = NULL;
+
+static pthread_once_t _span_once = PTHREAD_ONCE_INIT;
+
+/************************************************************************************************************/
+/* PUBLIC ***************************************************************************************************/
+/************************************************************************************************************/
+
+bool
+dg_base_fill_begin(cairo_t *c_ctx, dg_base_fill_t *fill)
+{
+	cairo_surface_t *c_srf = cairo_get_group_target(c_ctx);
+	cairo_rectangle_list_t *c_clip;
+
+	if (cairo_surface_get_type(c_srf) != CAIRO_SURFACE_TYPE_IMAGE) {
+		return false;
+	}
+
+	switch (cairo_image_surface_get_format(c_srf)) {
+
+		case CAIRO_FORMAT_ARGB32:
+		case CAIRO_FORMAT_RGB24:
+			break;
+
+		default:
+			return false;
+	}
+
+	/* pending cairo operations have to land before the buffer is touched */
+
+	cairo_surface_flush(c_srf);
+
+	if (!cairo_image_surface_get_data(c_srf)) {
+		return false;
+	}
+
+	c_clip = cairo_copy_clip_rectangle_list(c_ctx);
+	if (c_clip->status != CAIRO_STATUS_SUCCESS) {
+		cairo_rectangle_list_destroy(c_clip);
+		return false;
+	}
+
+	pthread_once(&_span_once, _span_pick);
+
+	fill->c_srf  = c_srf;
+	fill->c_clip = c_clip;
+	fill->data   = (uint32_t*)cairo_image_surface_get_data(c_srf);
+	fill->stride = cairo_image_surface_get_stride(c_srf) / sizeof(uint32_t);
+	fill->pw     = cairo_image_surface_get_width(c_srf);
+	fill->ph     = cairo_image_surface_get_height(c_srf);
+	fill->op     = cairo_get_operator(c_ctx);
+	fill->dirty  = false;
+
+	cairo_surface_get_device_offset(c_srf, &fill->off_x, &fill->off_y);
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+bool
+dg_base_fill_box(dg_base_fill_t *fill, double x1, double y1, double x2, double y2, dg_core_color_t cl, uint32_t px)
+{
+	/* only cases where the result is a plain pixel copy are handled */
+
+	switch (fill->op) {
+
+		case CAIRO_OPERATOR_SOURCE:
+			break;
+
+		case CAIRO_OPERATOR_OVER:
+			if (cl.a == 0.0) {
+				return true;
+			}
+			if (cl.a != 1.0) {
+				return false;
+			}
+			break;
+
+		default:
+			return false;
+	}
+
+	x1 += fill->off_x;
+	y1 += fill->off_y;
+	x2 += fill->off_x;
+	y2 += fill->off_y;
+
+	if (!_is_pixel_aligned(x1) || !_is_pixel_aligned(y1) || !_is_pixel_aligned(x2) || !_is_pixel_aligned(y2)) {
+		return false;
+	}
+
+	/* write each part of the box that is within a clip rectangle */
+
+	const cairo_rectangle_t *r;
+	uint32_t *row;
+	int cx1;
+	int cy1;
+	int cx2;
+	int cy2;
+
+	for (int i = 0; i < fill->c_clip->num_rectangles; i++) {
+		r = fill->c_clip->rectangles + i;
+		cx1 = _clamp(fmax(x1, floor(r->x + fill->off_x)), fill->pw);
+		cy1 = _clamp(fmax(y1, floor(r->y + fill->off_y)), fill->ph);
+		cx2 = _clamp(fmin(x2, ceil(r->x + r->width  + fill->off_x)), fill->pw);
+		cy2 = _clamp(fmin(y2, ceil(r->y + r->height + fill->off_y)), fill->ph);
+		if (cx1 >= cx2 || cy1 >= cy2) {
+			continue;
+		}
+		row = fill->data + (size_t)cy1 * fill->stride + cx1;
+		for (int j = cy1; j < cy2; j++) {
+			_span(row, cx2 - cx1, px);
+			row += fill->stride;
+		}
+		fill->dirty = true;
+	}
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_base_fill_end(dg_base_fill_t *fill)
+{
+	if (fill->dirty) {
+		cairo_surface_mark_dirty(fill->c_srf);
+	}
+
+	cairo_rectangle_list_destroy(fill->c_clip);
+}
+
+/************************************************************************************************************/
+/* _ ********************************************************************************************************/
+/************************************************************************************************************/
+
+static int
+_clamp(double v, int max)
+{
+	return v < 0.0 ? 0 : (v > max ? max : v);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_is_pixel_aligned(double v)
+{
+	return floor(v) == v;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+#ifdef _HAS_AVX2
+
+__attribute__((target("avx2")))
+static void
+_span_avx2(uint32_t *dst, size_t n, uint32_t px)
+{
+	const __m256i v = _mm256_set1_epi32((int)px);
+	size_t i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		_mm256_storeu_si256((__m256i*)(dst + i), v);
+	}
+
+	for (; i < n; i++) {
+		dst[i] = px;
+	}
+}
+
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+#ifdef _HAS_NEON
+
+static void
+_span_neon(uint32_t *dst, size_t n, uint32_t px)
+{
+	const uint32x4_t v = vdupq_n_u32(px);
+	size_t i = 0;
+
+	for (; i + 4 <= n; i += 4) {
+		vst1q_u32(dst + i, v);
+	}
+
+	for (; i < n; i++) {
+		dst[i] = px;
+	}
+}
+
+#endif
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_span_pick(void)
+{
+	_span = _span_scalar;
+
+	#if defined(_HAS_SSE2)
+	_span = _span_sse2;
+	#elif defined(_HAS_NEON)
+	_span = _span_neon;
+	#endif
+
+	#ifdef _HAS_AVX2
+	if (__builtin_cpu_supports("avx2")) {
+		_span = _span_avx2;
+	}
+	#endif
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_span_scalar(uint32_t *dst, size_t n, uint32_t px)
+{
+	for (size_t i = 0; i < n; i++) {
+		dst[i] = px;
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+#ifdef _HAS_SSE2
+
+static void
+_span_sse2(uint32_t *dst, size_t n, uint32_t px)
+{
+	const __m128i v = _mm_set1_epi32((int)px);
+	size_t i = 0;
+
+	/* rows are only 4 bytes aligned, align the stores on 16 bytes */
+
+	for (; i < n && ((uintptr_t)(dst + i) & 15); i++) {
+		dst[i] = px;
+	}
+
+	for (; i + 4 <= n; i += 4) {
+		_mm_store_si128((__m128i*)(dst + i), v);
+	}
+
+	for (; i < n; i++) {
+		dst[i] = px;
+	}
+}
+
+#endif
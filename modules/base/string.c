@@ -39,7 +39,9 @@
 /************************************************************************************************************/
 /************************************************************************************************************/
 
-static bool _is_end_char(char c);
+static void _clear_glyphs (dg_base_string_t *str);
+
+static bool _is_end_char (char c);
 
 /************************************************************************************************************/
 /* PUBLIC ***************************************************************************************************/
@@ -99,6 +101,7 @@ dg_base_string_clear(dg_base_string_t *str)
 	assert(str);
 
 	free(str->chars);
+	_clear_glyphs(str);
 
 	str->chars = NULL;
 	str->n_rows  = 0;
@@ -189,6 +192,8 @@ dg_base_string_recalculate_n_values(dg_base_string_t *str)
 	size_t n = 0;
 	bool end = false;
 
+	_clear_glyphs(str);
+
 	str->n_rows  = 0;
 	str->n_cols  = 0;
 	str->n_chars = 0;
@@ -326,6 +331,18 @@ dg_base_string_wrap(dg_base_string_t *str, size_t cw)
 /* _ ********************************************************************************************************/
 /************************************************************************************************************/
 
+static void
+_clear_glyphs(dg_base_string_t *str)
+{
+	for (size_t i = 0; i < 2; i++) {
+		free(str->glyphs[i]);
+		str->glyphs[i]     = NULL;
+		str->glyphs_gen[i] = 0;
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static bool
 _is_end_char(char c)
 {
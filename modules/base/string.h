@@ -33,7 +33,8 @@ extern "C" {
 /************************************************************************************************************/
 
 #define DG_BASE_STRING_EMPTY (dg_base_string_t){.chars = NULL, .n_rows = 0, .n_cols = 0, .n_chars = 0, \
-                                                .n_codepoints = 0}
+                                                .n_codepoints = 0, .glyphs = {NULL, NULL},     \
+                                                .glyphs_gen = {0, 0}}
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
@@ -45,6 +46,9 @@ extern "C" {
  * @param n_cols       : number of UTF8 chars columns taken by the string
  * @param n_chars      : number of raw bytes taken by the string
  * @param n_codepoints : number of UTF8 chars / codepoints taken by the string
+ * @param glyphs       : internal, font glyph indices per codepoint cached by the drawing functions, for the
+ *                       regular [0] and bold [1] font variants
+ * @param glyphs_gen   : internal, font generation (see dg_core_config_t) each glyph cache was built against
  */
 typedef struct {
 	char *chars;
@@ -52,6 +56,8 @@ typedef struct {
 	size_t n_cols;
 	size_t n_chars;
 	size_t n_codepoints;
+	unsigned long *glyphs[2];
+	unsigned int glyphs_gen[2];
 } dg_base_string_t;
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -68,7 +74,7 @@ typedef struct {
 void dg_base_string_append(dg_base_string_t *str, const char *str_raw);
 
 /**
- * Frees memory and zeros all paramaters of a given DG string.
+ * Frees memory and zeros all paramaters of a given DG string, glyph caches included.
  *
  * @param str : DG string to clear
  */
@@ -114,7 +120,8 @@ void dg_base_string_pad_custom(dg_base_string_t *str, const char *padder, size_t
 void dg_base_string_prepend(dg_base_string_t *str, const char *str_raw);
 
 /**
- * Recalculates a DG string's geometry and size.
+ * Recalculates a DG string's geometry and size. Cached glyphs are dropped as they may no longer match the
+ * string's contents.
  *
  * @param str : DG string to use
  */
@@ -30,6 +30,7 @@
 #include <dg/core/errno.h>
 
 #include "config.h"
+#include "draw.h"
 #include "zone.h"
 
 /************************************************************************************************************/
@@ -41,67 +42,15 @@ dg_base_zone_apply_core_font(dg_base_zone_t *z, bool bold)
 {	
 	assert(z && z->c_ctx);
 
-	cairo_antialias_t      antialias    = CAIRO_ANTIALIAS_DEFAULT;
-	cairo_subpixel_order_t subpixel     = CAIRO_SUBPIXEL_ORDER_DEFAULT;
-	cairo_hint_metrics_t   hint_metrics = CAIRO_HINT_METRICS_DEFAULT;
-	cairo_hint_style_t     hint_style   = CAIRO_HINT_STYLE_SLIGHT;
+	/* fonts are built by the core's config on each (re)configuration */
 
-	cairo_font_options_t *c_opt = cairo_font_options_create();
-	if (cairo_font_options_status(c_opt) != CAIRO_STATUS_SUCCESS) {
+	cairo_scaled_font_t *c_sft = bold ? DG_CORE_CONFIG->ft_c_sft_bold : DG_CORE_CONFIG->ft_c_sft_normal;
+	if (!c_sft) {
 		dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
-		cairo_font_options_destroy(c_opt);
 		return;
 	}
 
-	switch (DG_CORE_CONFIG->ft_antialias) {
-
-		case DG_CORE_CONFIG_ANTIALIAS_NONE:
-			antialias = CAIRO_ANTIALIAS_NONE;
-			break;
-		case DG_CORE_CONFIG_ANTIALIAS_GRAY:
-			antialias = CAIRO_ANTIALIAS_GRAY;
-			break;
-		case DG_CORE_CONFIG_ANTIALIAS_SUBPIXEL:
-			antialias = CAIRO_ANTIALIAS_SUBPIXEL;
-			break;
-	}
-
-	switch (DG_CORE_CONFIG->ft_subpixel) {
-
-		case DG_CORE_CONFIG_SUBPIXEL_RGB:
-			subpixel = CAIRO_SUBPIXEL_ORDER_RGB;
-			break;
-		case DG_CORE_CONFIG_SUBPIXEL_BGR:
-			subpixel = CAIRO_SUBPIXEL_ORDER_BGR;
-			break;
-		case DG_CORE_CONFIG_SUBPIXEL_VRGB:
-			subpixel = CAIRO_SUBPIXEL_ORDER_VRGB;
-			break;
-		case DG_CORE_CONFIG_SUBPIXEL_VBGR:
-			subpixel = CAIRO_SUBPIXEL_ORDER_VBGR;
-			break;
-	}
-
-	if (DG_CORE_CONFIG->ft_hint_metrics) {
-		hint_metrics = CAIRO_HINT_METRICS_ON;
-	} else {
-		hint_metrics = CAIRO_HINT_METRICS_OFF;
-	}
-
-	cairo_font_options_set_antialias(c_opt, antialias);
-	cairo_font_options_set_subpixel_order(c_opt, subpixel);
-	cairo_font_options_set_hint_metrics(c_opt, hint_metrics);
-	cairo_font_options_set_hint_style(c_opt, hint_style);
-
-	cairo_set_font_size(z->c_ctx, DG_CORE_CONFIG->ft_size);
-	cairo_set_font_options(z->c_ctx, c_opt);
-	cairo_select_font_face(
-		z->c_ctx,
-		DG_CORE_CONFIG->ft_face,
-		CAIRO_FONT_SLANT_NORMAL,
-		bold ? CAIRO_FONT_WEIGHT_BOLD : CAIRO_FONT_WEIGHT_NORMAL);
-
-	cairo_font_options_destroy(c_opt);
+	cairo_set_scaled_font(z->c_ctx, c_sft);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -111,6 +60,14 @@ dg_base_zone_clip(dg_base_zone_t *z)
 {
 	assert(z && z->c_ctx);
 
+	/* batched rectangles are drawn with the clip that is active when they get flushed */
+
+	dg_base_draw_batch_flush();
+
+	/* the context is saved so that unclipping restores the clip set by the core, if any */
+
+	cairo_save(z->c_ctx);
+
 	if (z->pw <= 0 || z->ph <= 0) {
 		return;
 	}
@@ -243,5 +200,6 @@ dg_base_zone_unclip(dg_base_zone_t *z)
 {
 	assert(z && z->c_ctx);
 
-	cairo_reset_clip(z->c_ctx);
+	dg_base_draw_batch_flush();
+	cairo_restore(z->c_ctx);
 }
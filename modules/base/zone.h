@@ -131,24 +131,26 @@ void dg_base_zone_pad(dg_base_zone_t *z, int16_t pad);
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 /**
- * Applies the font and its parameters defined in the Core's config.
+ * Applies the font and its parameters defined in the Core's config. The scaled fonts are prebuilt by the
+ * config, so this is a cheap operation.
  *
  * @param z    : zone to apply font settings to
  * @param bold : wheter or not apply a bold font variant
  *
- * @error DG_CORE_ERRNO_CAIRO : cairo font option creation failure
+ * @error DG_CORE_ERRNO_CAIRO : the config's scaled fonts could not be created
  */
 void dg_base_zone_apply_core_font(dg_base_zone_t *z, bool bold);
 
 /**
- * Clips the drawing context to the area defined by the zone.
+ * Clips the drawing context to the area defined by the zone. Each call has to be paired with a call to
+ * dg_base_zone_unclip().
  *
  * @param z : zone to use
  */
 void dg_base_zone_clip(dg_base_zone_t *z);
 
 /**
- * Unclips the drawing area.
+ * Unclips the drawing area, bringing back the clip that was in place when dg_base_zone_clip() was called.
  *
  * @param z : zone to use to retrieve the cairo context
  */
@@ -0,0 +1,54 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#ifndef DG_CORE_ATOM_H_PRIVATE
+#define DG_CORE_ATOM_H_PRIVATE
+
+#include <xcb/xcb.h>
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+/**
+ * Max amount of atom intern requests in flight at once.
+ */
+#define DG_CORE_ATOM_BATCH 64
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+/**
+ * Atom to intern, used by the core and the wm modules to batch their requests.
+ *
+ * @param name : name of the atom
+ * @param atom : where to write the atom once its request has been answered
+ */
+typedef struct {
+	const char *name;
+	xcb_atom_t *atom;
+} dg_core_atom_req_t;
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#endif /* DG_CORE_ATOM_H_PRIVATE */
@@ -19,11 +19,18 @@
 /************************************************************************************************************/
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "color.h"
 
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#define _TO_BYTE(X) ((uint32_t)((X) * 65535.0 + 0.5) >> 8)
+
 /************************************************************************************************************/
 /* PUBLIC ***************************************************************************************************/
 /************************************************************************************************************/
@@ -119,3 +126,14 @@ err:
 
 	return (dg_core_color_t){0};
 }
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+uint32_t
+dg_core_color_to_argb32(dg_core_color_t cl)
+{
+	return _TO_BYTE(cl.a)        << 24
+	     | _TO_BYTE(cl.r * cl.a) << 16
+	     | _TO_BYTE(cl.g * cl.a) << 8
+	     | _TO_BYTE(cl.b * cl.a);
+}
@@ -22,6 +22,7 @@
 #define DG_CORE_COLOR_H
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -90,6 +91,16 @@ dg_core_color_t dg_core_color_interpolate(dg_core_color_t cl_1, dg_core_color_t
  */
 dg_core_color_t dg_core_color_from_str(const char *str, bool *err);
 
+/**
+ * Packs a color into a premultiplied 32 bits ARGB pixel, as stored by cairo's ARGB32 and RGB24 image
+ * surfaces. Components are rounded the same way cairo rounds them for solid sources.
+ *
+ * @param cl : color to convert
+ *
+ * @return : self-explanatory
+ */
+uint32_t dg_core_color_to_argb32(dg_core_color_t cl);
+
 /************************************************************************************************************/
 /************************************************************************************************************/
 /************************************************************************************************************/
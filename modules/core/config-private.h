@@ -39,7 +39,8 @@
 bool dg_core_config_init(void);
 
 /**
- * Remove the module's config associated resource group from the resource tracker.
+ * Remove the module's config associated resource group from the resource tracker and destroy the generated
+ * scaled fonts.
  */
 void dg_core_config_reset(void);
 
@@ -46,6 +46,8 @@ typedef enum {
 	_WORD_ACTION_WINDOW,
 	_WORD_ACTION_MISC,
 	_WORD_FONT_OPTION,
+	_WORD_FONT_BACKEND,
+	_WORD_RENDER_BACKEND,
 } _word_group_t;
 
 /************************************************************************************************************/
@@ -63,6 +65,7 @@ static void _parse_swap   (char *prop, char *value, dg_core_config_swap_t (*swap
 static void _postprocess   (void);
 static bool _preprocess    (void);
 static void _set_defaults  (void);
+static void _set_fonts     (void);
 static void _set_generated (void);
 
 /************************************************************************************************************/
@@ -71,9 +74,11 @@ static void _set_generated (void);
 
 /* containers for string values to be post-processed */
 
-static char _raw_meta[DG_CORE_RESOURCE_STR_LEN]      = "";
-static char _raw_antialias[DG_CORE_RESOURCE_STR_LEN] = "";
-static char _raw_subpixel[DG_CORE_RESOURCE_STR_LEN]  = "";
+static char _raw_meta[DG_CORE_RESOURCE_STR_LEN]       = "";
+static char _raw_antialias[DG_CORE_RESOURCE_STR_LEN]  = "";
+static char _raw_subpixel[DG_CORE_RESOURCE_STR_LEN]   = "";
+static char _raw_ft_backend[DG_CORE_RESOURCE_STR_LEN] = "";
+static char _raw_backend[DG_CORE_RESOURCE_STR_LEN]    = "";
 
 /* config data */
 
@@ -96,6 +101,7 @@ static const dg_core_resource_t _res[] = {
 	{ "font_enable_hint_metrics",         DG_CORE_RESOURCE_BOOL,    &_conf.ft_hint_metrics          },
 	{ "font_antialias",                   DG_CORE_RESOURCE_STR,     &_raw_antialias                 },
 	{ "font_subpixel_order",              DG_CORE_RESOURCE_STR,     &_raw_subpixel                  },
+	{ "font_backend",                     DG_CORE_RESOURCE_STR,     &_raw_ft_backend                },
 
 	{ "window_enable_dynamic_border",     DG_CORE_RESOURCE_BOOL,    &_conf.win_dynamic_bd           },
 	{ "window_focus_when_activated",      DG_CORE_RESOURCE_BOOL,    &_conf.win_focused_on_activate  },
@@ -122,7 +128,12 @@ static const dg_core_resource_t _res[] = {
 	{ "misc_allow_cell_to_lock_focus",    DG_CORE_RESOURCE_BOOL,    &_conf.cell_auto_lock           },
 	{ "misc_enable_persistent_pointer",   DG_CORE_RESOURCE_BOOL,    &_conf.input_persistent_pointer },
 	{ "misc_enable_persistent_touch",     DG_CORE_RESOURCE_BOOL,    &_conf.input_persistent_touch   },
+	{ "misc_enable_input_coalescing",     DG_CORE_RESOURCE_BOOL,    &_conf.input_coalesce           },
 	{ "misc_animation_framerate_divider", DG_CORE_RESOURCE_UINT,    &_conf.anim_divider             },
+	{ "misc_render_backend",              DG_CORE_RESOURCE_STR,     &_raw_backend                   },
+	{ "misc_retained_cache_budget",       DG_CORE_RESOURCE_UINT,    &_conf.retain_budget            },
+	{ "misc_render_threads",              DG_CORE_RESOURCE_UINT,    &_conf.render_threads           },
+	{ "misc_enable_render_thread",        DG_CORE_RESOURCE_BOOL,    &_conf.render_thread            },
 };
 
 static const dg_core_resource_group_t _group_main = {
@@ -228,6 +239,12 @@ static const dg_core_util_fat_dict_t _words[] = {
 	{ "bgr",       DG_CORE_CONFIG_SUBPIXEL_BGR,             _WORD_FONT_OPTION   },
 	{ "vrgb",      DG_CORE_CONFIG_SUBPIXEL_VRGB,            _WORD_FONT_OPTION   },
 	{ "vbgr",      DG_CORE_CONFIG_SUBPIXEL_VBGR,            _WORD_FONT_OPTION   },
+
+	{ "cairo",     DG_CORE_CONFIG_FONT_CAIRO,               _WORD_FONT_BACKEND  },
+	{ "atlas",     DG_CORE_CONFIG_FONT_ATLAS,               _WORD_FONT_BACKEND  },
+
+	{ "xcb",       DG_CORE_CONFIG_RENDER_XCB,               _WORD_RENDER_BACKEND },
+	{ "shm",       DG_CORE_CONFIG_RENDER_SHM,               _WORD_RENDER_BACKEND },
 };
 
 /************************************************************************************************************/
@@ -355,6 +372,12 @@ dg_core_config_reset(void)
 	dg_core_resource_pull_group(&_group_main);
 	dg_core_resource_pull_group(&_group_button);
 	dg_core_resource_pull_group(&_group_key);
+
+	cairo_scaled_font_destroy(_conf.ft_c_sft_normal);
+	cairo_scaled_font_destroy(_conf.ft_c_sft_bold);
+
+	_conf.ft_c_sft_normal = NULL;
+	_conf.ft_c_sft_bold   = NULL;
 }
 
 /************************************************************************************************************/
@@ -390,6 +413,16 @@ _postprocess(void)
 		_conf.ft_subpixel = val;
 	}
 
+	val = dg_core_hashtable_get_value(&_hm, _raw_ft_backend, _WORD_FONT_BACKEND, &found);
+	if (found) {
+		_conf.ft_backend = val;
+	}
+
+	val = dg_core_hashtable_get_value(&_hm, _raw_backend, _WORD_RENDER_BACKEND, &found);
+	if (found) {
+		_conf.render_backend = val;
+	}
+
 	/* apply generated values */
 
 	_set_generated();
@@ -605,6 +638,7 @@ _set_defaults(void)
 	_conf.ft_hint_metrics = true;
 	_conf.ft_antialias    = DG_CORE_CONFIG_ANTIALIAS_SUBPIXEL;
 	_conf.ft_subpixel     = DG_CORE_CONFIG_SUBPIXEL_RGB;
+	_conf.ft_backend      = DG_CORE_CONFIG_FONT_CAIRO;
 
 	/* window */
 
@@ -641,7 +675,12 @@ _set_defaults(void)
 	_conf.cell_auto_lock           = true;
 	_conf.input_persistent_pointer = false;
 	_conf.input_persistent_touch   = false;
+	_conf.input_coalesce           = true;
 	_conf.anim_divider             = 1;
+	_conf.render_backend           = DG_CORE_CONFIG_RENDER_XCB;
+	_conf.retain_budget            = 16384;
+	_conf.render_threads           = 1;
+	_conf.render_thread            = false;
 
 	/* input swaps */
 
@@ -689,6 +728,106 @@ _set_defaults(void)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static void
+_set_fonts(void)
+{
+	cairo_scaled_font_destroy(_conf.ft_c_sft_normal);
+	cairo_scaled_font_destroy(_conf.ft_c_sft_bold);
+
+	_conf.ft_c_sft_normal = NULL;
+	_conf.ft_c_sft_bold   = NULL;
+
+	/* translate font options */
+
+	cairo_antialias_t      antialias    = CAIRO_ANTIALIAS_DEFAULT;
+	cairo_subpixel_order_t subpixel     = CAIRO_SUBPIXEL_ORDER_DEFAULT;
+	cairo_hint_metrics_t   hint_metrics = CAIRO_HINT_METRICS_DEFAULT;
+	cairo_hint_style_t     hint_style   = CAIRO_HINT_STYLE_SLIGHT;
+
+	switch (_conf.ft_antialias) {
+
+		case DG_CORE_CONFIG_ANTIALIAS_NONE:
+			antialias = CAIRO_ANTIALIAS_NONE;
+			break;
+		case DG_CORE_CONFIG_ANTIALIAS_GRAY:
+			antialias = CAIRO_ANTIALIAS_GRAY;
+			break;
+		case DG_CORE_CONFIG_ANTIALIAS_SUBPIXEL:
+			antialias = CAIRO_ANTIALIAS_SUBPIXEL;
+			break;
+	}
+
+	switch (_conf.ft_subpixel) {
+
+		case DG_CORE_CONFIG_SUBPIXEL_RGB:
+			subpixel = CAIRO_SUBPIXEL_ORDER_RGB;
+			break;
+		case DG_CORE_CONFIG_SUBPIXEL_BGR:
+			subpixel = CAIRO_SUBPIXEL_ORDER_BGR;
+			break;
+		case DG_CORE_CONFIG_SUBPIXEL_VRGB:
+			subpixel = CAIRO_SUBPIXEL_ORDER_VRGB;
+			break;
+		case DG_CORE_CONFIG_SUBPIXEL_VBGR:
+			subpixel = CAIRO_SUBPIXEL_ORDER_VBGR;
+			break;
+	}
+
+	if (_conf.ft_hint_metrics) {
+		hint_metrics = CAIRO_HINT_METRICS_ON;
+	} else {
+		hint_metrics = CAIRO_HINT_METRICS_OFF;
+	}
+
+	/* create fonts */
+
+	cairo_font_options_t *c_opt = cairo_font_options_create();
+	cairo_font_face_t    *c_fnt = cairo_toy_font_face_create(
+		_conf.ft_face,
+		CAIRO_FONT_SLANT_NORMAL,
+		CAIRO_FONT_WEIGHT_NORMAL);
+	cairo_font_face_t    *c_fnt_bold = cairo_toy_font_face_create(
+		_conf.ft_face,
+		CAIRO_FONT_SLANT_NORMAL,
+		CAIRO_FONT_WEIGHT_BOLD);
+	if (cairo_font_options_status(c_opt)   != CAIRO_STATUS_SUCCESS ||
+	    cairo_font_face_status(c_fnt)      != CAIRO_STATUS_SUCCESS ||
+	    cairo_font_face_status(c_fnt_bold) != CAIRO_STATUS_SUCCESS) {
+		dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
+		goto fail_setup;
+	}
+
+	cairo_font_options_set_antialias(c_opt, antialias);
+	cairo_font_options_set_subpixel_order(c_opt, subpixel);
+	cairo_font_options_set_hint_metrics(c_opt, hint_metrics);
+	cairo_font_options_set_hint_style(c_opt, hint_style);
+
+	cairo_matrix_t c_mat_font;
+	cairo_matrix_t c_mat_ctm;
+
+	cairo_matrix_init_scale(&c_mat_font, _conf.ft_size, _conf.ft_size);
+	cairo_matrix_init_identity(&c_mat_ctm);
+
+	_conf.ft_c_sft_normal = cairo_scaled_font_create(c_fnt,      &c_mat_font, &c_mat_ctm, c_opt);
+	_conf.ft_c_sft_bold   = cairo_scaled_font_create(c_fnt_bold, &c_mat_font, &c_mat_ctm, c_opt);
+	if (cairo_scaled_font_status(_conf.ft_c_sft_normal) != CAIRO_STATUS_SUCCESS ||
+	    cairo_scaled_font_status(_conf.ft_c_sft_bold)   != CAIRO_STATUS_SUCCESS) {
+		dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
+		cairo_scaled_font_destroy(_conf.ft_c_sft_normal);
+		cairo_scaled_font_destroy(_conf.ft_c_sft_bold);
+		_conf.ft_c_sft_normal = NULL;
+		_conf.ft_c_sft_bold   = NULL;
+	}
+
+fail_setup:
+
+	cairo_font_face_destroy(c_fnt_bold);
+	cairo_font_face_destroy(c_fnt);
+	cairo_font_options_destroy(c_opt);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static void
 _set_generated(void)
 {
@@ -758,4 +897,14 @@ skip_font_setup:
 skip_auto_font:
 
 	_conf.ft_ph = _conf.ft_ascent + _conf.ft_descent;
+
+	/* build the fonts used for drawing */
+
+	_set_fonts();
+
+	/* invalidate font dependent caches, 0 is reserved for "never built" */
+
+	if (++_conf.ft_generation == 0) {
+		_conf.ft_generation = 1;
+	}
 }
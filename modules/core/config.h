@@ -24,6 +24,8 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+#include <cairo/cairo.h>
+
 #include "color.h"
 #include "resource.h"
 
@@ -81,6 +83,30 @@ typedef enum {
 	DG_CORE_CONFIG_SUBPIXEL_VBGR,
 } dg_core_config_font_subpixel_t;
 
+/**
+ * Ways text gets rasterized.
+ * CAIRO : glyphs go through cairo's regular glyph rendering pipeline.
+ * ATLAS : glyphs are pre-rasterized once in grayscale into a per font variant atlas, then copied as masks
+ *         filled with the text's color. Subpixel antialiasing is not available with this backend.
+ */
+typedef enum {
+	DG_CORE_CONFIG_FONT_CAIRO,
+	DG_CORE_CONFIG_FONT_ATLAS,
+} dg_core_config_font_backend_t;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Ways window contents get rasterized and transferred to the X server.
+ * XCB : cairo draws into server-side pixmaps, every drawing operation is a request.
+ * SHM : cairo draws into client-side image surfaces backed by MIT-SHM segments, only the damaged rectangles
+ *       are then copied to the server.
+ */
+typedef enum {
+	DG_CORE_CONFIG_RENDER_XCB,
+	DG_CORE_CONFIG_RENDER_SHM,
+} dg_core_config_render_backend_t;
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 /**
@@ -181,6 +207,10 @@ typedef enum {
  * @param ft_hint_metrics          : enable font hint metrics
  * @param ft_antialias             : font antialiasing type
  * @param ft_subpixel              : font subpixel order
+ * @param ft_backend               : text rasterization backend
+ * @param ft_generation            : generated value, changes each time the font setup is recalculated, never 0
+ * @param ft_c_sft_normal          : generated value, cairo scaled font of the regular font variant, may be NULL
+ * @param ft_c_sft_bold            : generated value, cairo scaled font of the bold font variant, may be NULL
  * @param win_focused_on_activate  : cope option in case the wm does not automatically focus a new window
  * @param win_dynamic_bd           : show window states by coloring the window's border
  * @param win_thick_bd             : post-scaling value, pixel thickness of the window border
@@ -204,7 +234,12 @@ typedef enum {
  * @param cell_auto_lock           : allow cells to request focus locks in response to events
  * @param input_persistent_pointer : keep focus after the pointer leaves the cell's area
  * @param input_persistent_touch   : keep focus after the first touch ends
+ * @param input_coalesce           : merge queued pointer motions and focus key repeats before dispatch
  * @param anim_divider             : framerate divider based on the screen's refresh rate, 0 to unsync
+ * @param render_backend           : requested rendering backend, see dg_core_get_render_backend() for the active one
+ * @param retain_budget            : memory budget in KiB of the retained cells renderings cache, 0 to disable it
+ * @param render_threads           : number of threads rasterizing window areas, 0 and 1 keep everything on the loop
+ * @param render_thread            : draw frames on a dedicated thread while the loop keeps processing events
  * @param swap_key                 : swap-map for keyboard inputs
  * @param swap_but                 : swap-map for pointer button inputs
  */
@@ -229,6 +264,10 @@ typedef struct {
 	bool ft_hint_metrics;
 	dg_core_config_font_antialias_t ft_antialias;
 	dg_core_config_font_subpixel_t ft_subpixel;
+	dg_core_config_font_backend_t ft_backend;
+	unsigned int ft_generation;
+	cairo_scaled_font_t *ft_c_sft_normal;
+	cairo_scaled_font_t *ft_c_sft_bold;
 	/* window */
 	bool win_focused_on_activate;
 	bool win_dynamic_bd;
@@ -255,7 +294,12 @@ typedef struct {
 	bool cell_auto_lock;
 	bool input_persistent_pointer;
 	bool input_persistent_touch;
+	bool input_coalesce;
 	unsigned int anim_divider;
+	dg_core_config_render_backend_t render_backend;
+	unsigned int retain_budget;
+	unsigned int render_threads;
+	bool render_thread;
 	/* input swaps */
 	dg_core_config_swap_t swap_key[DG_CORE_CONFIG_MAX_KEYS    + 1][3];
 	dg_core_config_swap_t swap_but[DG_CORE_CONFIG_MAX_BUTTONS + 1][3];
@@ -20,14 +20,20 @@
 
 #include <assert.h>
 #include <math.h>
+#include <poll.h>
 #include <stdbool.h>
 #include <pthread.h>
 #include <signal.h>
+#include <stdatomic.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <time.h>
 #include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <sys/timerfd.h>
 
 #include <cairo/cairo.h>
 #include <cairo/cairo-xcb.h>
@@ -37,15 +43,20 @@
 #include <xcb/xcb_keysyms.h>
 #include <xcb/present.h>
 #include <xcb/randr.h>
+#include <xcb/shm.h>
 #include <xcb/xinput.h>
 #include <xkbcommon/xkbcommon.h>
 
 #include "atom.h"
+#include "atom-private.h"
 #include "config.h"
 #include "config-private.h"
 #include "core.h"
 #include "errno.h"
 #include "input_buffer.h"
+#include "map.h"
+#include "queue.h"
+#include "slotmap.h"
 #include "stack.h"
 #include "util.h"
 
@@ -56,15 +67,31 @@
 /* macros for common parameter checking */
 
 #define _IS_INIT      assert(_init);
-#define _IS_WINDOW(X) assert(dg_core_stack_find(&_windows, X, &X->id));
-#define _IS_GRID(X)   assert(dg_core_stack_find(&_grids,   X, &X->id));
-#define _IS_CELL(X)   assert(dg_core_stack_find(&_cells,   X, &X->id));
+#define _IS_WINDOW(X) assert(dg_core_slotmap_find(&_windows, X, X->id));
+#define _IS_GRID(X)   assert(dg_core_slotmap_find(&_grids,   X, X->id));
+#define _IS_CELL(X)   assert(dg_core_slotmap_find(&_cells,   X, X->id));
+#define _IS_TIMER(X)  assert(dg_core_stack_find(&_timers,  X, &X->id));
 
 /* macros for running callbacks */
 
 #define _RUN_FN(X, ...)        if (X)  {X(__VA_ARGS__);}
 #define _RUN_INT_FN(X, Y, ...) if (X && X(__VA_ARGS__)) {Y;}
 
+/* cross-thread message queue capacity, must be a power of 2 */
+
+#define _MESSAGES_LEN 1024
+
+/* number of Present pixmaps each window renders into */
+
+#define _WINDOW_BUFFERS 3
+
+/* frame pacing : spare time in microseconds kept before the vblank, on-time frames needed to undo a divider */
+/* raise, and how far the framerate divider can be raised above the configured one after missed frames     */
+
+#define _PACE_MARGIN   1000
+#define _PACE_RECOVERY 120
+#define _PACE_MAX_RISE 3
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 typedef enum {
@@ -113,13 +140,20 @@ typedef struct {
 } _accel_t;
 
 typedef struct {
-	size_t id;
+	dg_core_slotmap_id_t id;
+	dg_core_slotmap_id_t id_cell; /* handle in c->areas, i = SIZE_MAX once c is destroyed */
 	bool redraw;
+	size_t dirty_id; /* position in its grid's dirty set while redraw is set */
+	_rect_t clip; /* part of the area to redraw, relative to it, w = 0 for the whole area */
 	dg_core_cell_t *c;
 	dg_core_grid_t *g_parent;
 	dg_core_input_buffer_t touches;
 	int16_t cx, cy, cw, ch;
 	int16_t px, py, pw, ph;
+	dg_core_window_t *wake_w; /* window whose wake heap holds the area, NULL if none            */
+	size_t wake_id;           /* position in the wake heap, SIZE_MAX if no update is due         */
+	unsigned long wake;       /* time at which the area is due for an update                     */
+	_rect_t wake_clip;        /* part of the area to redraw once due, w = 0 for the whole area   */
 } _area_t;
 
 typedef struct {
@@ -127,6 +161,72 @@ typedef struct {
 	size_t n;
 } _area_list_t;
 
+typedef struct {
+	_area_t *a;
+	dg_core_cell_drawing_context_t dc;
+	_rect_t rect_clip; /* part of the window that gets redrawn                   */
+	bool clip;         /* true if rect_clip only covers part of the area          */
+	bool done;         /* set by render threads once the cell has been drawn      */
+	cairo_surface_t *c_retained; /* retained rendering to blit (referenced), NULL if none */
+	bool retain_fill;            /* c_retained is blank and has to be drawn first         */
+} _area_job_t;
+
+typedef struct {
+	dg_core_window_t *w; /* window the frame belongs to, NULL if no frame is in flight */
+	cairo_surface_t *c_srf;
+	_area_job_t *jobs;   /* areas to draw, in drawing order                            */
+	size_t n_jobs;
+	size_t n_jobs_alloc;
+	size_t i_back;       /* buffer the frame is presented from                         */
+	unsigned long delay;
+	bool drawn;          /* set by the render thread once it went through all jobs     */
+} _frame_t;
+
+typedef struct {
+	int fd;
+	short events;
+	void (*fn)(int fd, short revents);
+} _fd_watch_t;
+
+typedef struct {
+	atomic_size_t seq; /* slot turn, see _loop_push_message() */
+	bool is_signal;
+	uint32_t serial;
+	void *data;
+} _message_t;
+
+typedef struct {
+	xcb_pixmap_t x_pix;
+	cairo_surface_t *c_srf;
+	cairo_t *c_ctx;
+	uint32_t frame;      /* serial of the frame the pixmap holds, 0 if its content is undefined */
+	bool idle;           /* false while the X server may still read from the pixmap             */
+	uint64_t target_msc; /* MSC the frame was meant to be shown at, 0 for as soon as possible   */
+} _window_buffer_t;
+
+typedef struct {
+	xcb_shm_seg_t x_seg;
+	uint8_t *data;
+	cairo_surface_t *c_srf;
+	cairo_t *c_ctx;
+	cairo_region_t *damage; /* pixels drawn since the last frame was pushed to a pixmap     */
+	size_t n_pushes;        /* pushes the X server has not confirmed yet, see _event_shm()   */
+	bool pending;           /* a redraw waits for the X server to be done with the segment  */
+} _window_image_t;
+
+typedef struct _retained_t _retained_t;
+struct _retained_t {
+	dg_core_cell_t *c;
+	int16_t pw, ph;
+	dg_core_cell_focus_t focus;
+	bool ena;
+	bool win_ena;
+	cairo_surface_t *c_srf; /* NULL if the cell can't be retained in this state */
+	bool filling;           /* c_srf is being drawn by the render thread        */
+	_retained_t *prev;      /* more recently used neighbour                    */
+	_retained_t *next;      /* less recently used neighbour                    */
+};
+
 typedef struct {
 	xcb_timestamp_t time;
 	bool owned;
@@ -143,9 +243,14 @@ typedef struct {
 
 struct _cell_t {
 	unsigned int serial;
-	size_t id;
+	dg_core_slotmap_id_t id;
+	dg_core_slotmap_t areas; /* areas the cell is assigned to, across all grids */
 	bool to_destroy;
 	bool ena;
+	bool retained;
+	dg_core_stack_t retains; /* cached renderings, see _retained_t */
+	bool threaded;
+	pthread_mutex_t mutex;   /* recursive, held while the cell is drawn or modified */
 	void *props;
 	void (*fn_draw)(dg_core_cell_t *c, dg_core_cell_drawing_context_t *dc);
 	void (*fn_event)(dg_core_cell_t *c, dg_core_cell_event_t *ev);
@@ -153,10 +258,14 @@ struct _cell_t {
 };
 
 struct _grid_t {
-	size_t id;
+	dg_core_slotmap_id_t id;
 	bool to_destroy;
 	bool used;
-	dg_core_stack_t areas;
+	dg_core_slotmap_t areas;
+	_area_t **dirty;  /* areas with a pending redraw, sized to hold all of them */
+	size_t n_dirty;
+	size_t n_dirty_alloc;
+	dg_core_window_t *w_parent;
 	int16_t cw, ch;
 	int16_t pw, ph;
 	int16_t *chu;
@@ -167,24 +276,60 @@ struct _grid_t {
 	double  n_fwu;
 	int16_t n_chu, n_chu_inv;
 	int16_t n_cwu, n_cwu_inv;
+	int16_t *pxo;          /* pixel offset of each column and row at minimum size, with one extra end entry */
+	int16_t *pyo;
+	int16_t *fxo;          /* extra pixel offset of each column and row gained by growth, same layout        */
+	int16_t *fyo;
+	int16_t fxo_n, fyo_n;  /* extra pixels fxo and fyo have been spread for, INT16_MIN when out of date     */
 	dg_core_grid_t *g_ref;
 };
 
-struct _window_t {
+struct _timer_t {
 	size_t id;
+	size_t heap_id; /* position in the deadline heap, SIZE_MAX if stopped */
+	unsigned long deadline;
+	unsigned long period;
+	void *props;
+	void (*fn)(dg_core_timer_t *t);
+};
+
+struct _window_t {
+	dg_core_slotmap_id_t id;
 	bool to_destroy;
 	/* visual update data */
 	_window_render_level_t render_level;
 	_window_present_schedule_t present_schedule;
+	bool present_queued;        /* in _windows_dirty, so that marking a window does not scan it */
 	uint32_t present_serial;
 	unsigned long last_render_time;
+	/* frame pacing */
+	unsigned long render_cost;  /* recent time in microseconds a frame took to render          */
+	unsigned long msc_period;   /* estimated refresh period in microseconds, 0 until known      */
+	unsigned long msc_ust;      /* time of the last notified MSC                                */
+	uint64_t msc;               /* last notified MSC                                            */
+	uint64_t msc_target;        /* MSC the next frame is meant to be shown at, 0 for ASAP       */
+	unsigned int divider_rise;  /* added to the configured framerate divider after missed frames */
+	unsigned int on_time;       /* frames shown on time since the last missed one               */
+	unsigned long missed;       /* frames shown after their target MSC                          */
+	bool low_latency;
+	dg_core_timer_t *pace_timer;
+	/* areas waiting for a deadline to be updated, see DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE_AT */
+	_area_t **wakes;            /* min-heap ordered by deadline                                 */
+	size_t n_wakes;
+	size_t n_wakes_alloc;
+	dg_core_timer_t *wake_timer; /* armed on the earliest deadline while the window is visible  */
 	/* input trackers */
 	dg_core_input_buffer_t buttons;
 	dg_core_input_buffer_t touches;
 	/* visual elements */
 	xcb_window_t x_win;
+	xcb_gcontext_t x_gc;
 	cairo_t *c_ctx;
 	cairo_surface_t *c_srf;
+	_window_buffer_t bufs[_WINDOW_BUFFERS];
+	_window_image_t img; /* client side frame, only used by the SHM backend */
+	size_t i_front;
+	uint32_t frame;
 	/* base properties */
 	const char *name;
 	const char *name_icon;
@@ -214,10 +359,10 @@ struct _window_t {
 
 /* X helpers */
 
-static xcb_atom_t      _x_get_atom                (const char *name);
+static void            _x_get_atoms               (const dg_core_atom_req_t *reqs, size_t n);
 static xcb_atom_t      _x_get_atom_sel            (int selection);
 static xcb_atom_t      _x_get_atom_sel_target     (int selection);
-static uint8_t         _x_get_extension_opcode    (const char *name);
+static uint8_t         _x_get_extension_opcode    (xcb_query_extension_cookie_t xc);
 static _rect_t         _x_get_monitor_geometry_at (int16_t px, int16_t py);
 static int             _x_get_selection_id        (xcb_atom_t xa);
 static xcb_timestamp_t _x_get_timestamp           (void);
@@ -242,6 +387,7 @@ static void _event_motion            (xcb_motion_notify_event_t *x_ev);
 static void _event_present           (xcb_present_generic_event_t *x_ev);
 static void _event_selection_clear   (xcb_selection_clear_event_t *x_ev);
 static void _event_selection_request (xcb_selection_request_event_t *x_ev);
+static void _event_shm               (xcb_shm_completion_event_t *x_ev);
 static void _event_unmap             (xcb_unmap_notify_event_t *x_ev);
 static void _event_visibility        (xcb_visibility_notify_event_t *x_ev);
 static void _event_xinput_touch      (xcb_input_touch_begin_event_t *x_ev);
@@ -261,24 +407,72 @@ static void _sub_event_touch_update  (dg_core_window_t *w, uint32_t id, int16_t
 
 /* procedures with side effects */
 
+static void _area_clear_redraw       (_area_t *a);
+static bool _area_draw_retained      (_area_t *a, dg_core_window_t *w, dg_core_cell_drawing_context_t *dc);
 static void _area_redraw             (_area_t *a, dg_core_window_t *w, unsigned long delay); 
+static void _area_redraw_draw        (_area_t *a, dg_core_window_t *w, _area_job_t *job);
+static void _area_redraw_finish      (_area_t *a, dg_core_window_t *w, const _area_job_t *job);
+static bool _area_redraw_prepare     (_area_t *a, dg_core_window_t *w, unsigned long delay, _area_job_t *job);
+static void _area_request_redraw     (_area_t *a, const _rect_t *region);
 static void _area_update_geometry    (_area_t *a, dg_core_grid_t  *g, bool is_popup);
 static void _cell_destroy            (dg_core_cell_t *c);
+static void _cell_draw               (dg_core_cell_t *c, dg_core_cell_drawing_context_t *dc);
 static bool _cell_process_bare_event (dg_core_cell_t *c, dg_core_cell_event_t *cev);
+static void _cell_unlock             (dg_core_cell_t *c);
 static void _clipboard_clear         (int clipboard);
 static void _grid_destroy            (dg_core_grid_t *g);
 static void _grid_update_geometry    (dg_core_grid_t *g, bool is_popup);
+static void _grid_update_growth      (dg_core_grid_t *g, int16_t nw, int16_t nh);
+static void _loop_coalesce_events    (void);
+static void _loop_dispatch_event     (xcb_generic_event_t *x_ev);
+static bool _loop_fill_events        (void);
+static int  _loop_poll_fds           (int timeout);
+static void _loop_process_messages   (int fd, short revents);
+static bool _loop_push_message       (bool is_signal, uint32_t serial, void *data);
+static void _loop_run_epilogue       (void);
+static bool _loop_wait_events        (void);
 static void _misc_reconfig           (void);
+static void _timer_arm               (void);
+static void _timer_heap_pull         (dg_core_timer_t *t);
+static bool _timer_heap_push         (dg_core_timer_t *t);
+static void _timer_heap_sift         (size_t i);
+static void _timer_process           (int fd, short revents);
+static void _pool_drain              (void);
+static void _pool_run                (cairo_surface_t *c_srf);
+static bool _pool_start              (void);
+static void _pool_stop               (void);
 static bool _popup_grab_inputs       (void);
 static void _popup_ungrab_inputs     (void);
 static void _popup_kill              (_popup_t *p);
-
+static void _render_complete         (void);
+static void _render_draw             (void);
+static bool _render_draw_retained    (_area_job_t *job, cairo_t *c_ctx);
+static bool _render_handoff          (dg_core_window_t *w, size_t i_back, unsigned long delay);
+static bool _render_lock_cell        (dg_core_cell_t *c);
+static void _render_process          (int fd, short revents);
+static bool _render_start            (void);
+static void _render_stop             (void);
+static void _render_wait             (void);
+static void _retain_clear            (dg_core_cell_t *c);
+static void _retain_pull             (_retained_t *r);
+static void _retain_trim             (void);
+static void _retain_use              (_retained_t *r);
+
+static void _window_add_damage            (dg_core_window_t *w, _rect_t rect);
+static void _window_batch_draws           (dg_core_window_t *w, bool open);
 static void _window_destroy               (dg_core_window_t *w);
 static void _window_focus_by_pointer      (dg_core_window_t *w, int16_t px, int16_t py);
+static void _window_pace                  (dg_core_window_t *w, uint64_t msc, unsigned long ust);
+static void _window_pace_account          (dg_core_window_t *w, uint32_t serial, uint64_t msc);
+static void _window_pace_expire           (dg_core_timer_t *t);
 static void _window_present               (dg_core_window_t *w);
 static bool _window_process_cell_event    (dg_core_window_t *w, _area_t *a, dg_core_cell_event_t *cev);
+static void _window_push_damage           (dg_core_window_t *w, xcb_pixmap_t x_pix);
 static void _window_redraw                (dg_core_window_t *w);
+static void _window_redraw_end            (dg_core_window_t *w, size_t i_back, unsigned long delay);
+static void _window_redraw_unfocused      (dg_core_window_t *w, unsigned long delay);
 static void _window_refocus               (dg_core_window_t *w);
+static void _window_reset_buffers         (dg_core_window_t *w);
 static void _window_resize                (dg_core_window_t *w, int16_t pw, int16_t ph);
 static void _window_send_event_to_all     (dg_core_window_t *w, dg_core_cell_event_t *cev);
 static void _window_set_focus             (dg_core_window_t *w, _area_t *a);
@@ -287,13 +481,24 @@ static void _window_set_present_schedule  (dg_core_window_t *w, _window_present_
 static void _window_set_render_level      (dg_core_window_t *w, _window_render_level_t render_level);
 static void _window_set_state             (dg_core_window_t *w, dg_core_window_state_t state, dg_core_window_state_setting_mode_t mode);
 static void _window_toggle_state          (dg_core_window_t *w, dg_core_window_state_t state_bits);
+static bool _window_update_buffers        (dg_core_window_t *w);
 static void _window_update_current_grid   (dg_core_window_t *w);
 static void _window_update_geometries     (dg_core_window_t *w, bool is_popup);
+static bool _window_update_image          (dg_core_window_t *w, uint16_t pw, uint16_t ph);
 static void _window_update_wm_focus_hints (dg_core_window_t *w);
 static void _window_update_wm_size_hints  (dg_core_window_t *w);
-
+static void _window_wake_arm              (dg_core_window_t *w);
+static void _window_wake_clear            (dg_core_window_t *w);
+static void _window_wake_expire           (dg_core_timer_t *t);
+static void _window_wake_pull             (dg_core_window_t *w, _area_t *a);
+static bool _window_wake_push             (dg_core_window_t *w, _area_t *a);
+static void _window_wake_sift             (dg_core_window_t *w, size_t i);
+
+static void             *_pool_work                (void *arg);
 static dg_core_window_t *_popup_prep_core_input   (xcb_key_press_event_t *x_ev);
 static dg_core_window_t *_popup_prep_motion_input (xcb_motion_notify_event_t *x_ev);
+static void             *_render_work              (void *arg);
+static _retained_t      *_retain_create           (dg_core_cell_t *c, const dg_core_cell_drawing_context_t *dc, cairo_surface_t *c_srf_ref);
 static dg_core_window_t *_window_create           (bool fixed, bool redirect);
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -304,14 +509,19 @@ static _rect_t               _area_get_current_geometry (_area_t *a, dg_core_win
 static dg_core_cell_focus_t  _area_get_focus_type       (_area_t *a, dg_core_window_t *w);
 static _area_t              *_grid_find_first_area      (dg_core_grid_t *g, dg_core_cell_t *c);
 static _area_list_t          _grid_get_neighbour_areas  (dg_core_grid_t *g, _area_t *a);
+static _fd_watch_t          *_loop_find_fd              (int fd);
 static dg_core_window_t     *_loop_find_window          (xcb_window_t x_win);
 static bool                  _loop_no_active_windows    (void);
+static bool                  _misc_get_input_swap       (xcb_key_press_event_t *x_ev, dg_core_config_swap_t *swap);
 static _rect_t               _popup_get_geometry        (dg_core_window_t *w_ref, int16_t px, int16_t px_alt, int16_t py_alt, int16_t py, int16_t pw, int16_t ph);
 static _popup_t             *_popup_find_under_coords   (int16_t px, int16_t py);
+static _retained_t          *_retain_find               (dg_core_cell_t *c, const dg_core_cell_drawing_context_t *dc);
 
 static _area_t         *_window_find_area_under_coords (dg_core_window_t *w, int16_t px, int16_t py);
+static size_t           _window_find_idle_buffer       (dg_core_window_t *w);
 static dg_core_grid_t  *_window_find_smallest_grid     (dg_core_window_t *w);
 static dg_core_color_t  _window_get_border_color       (dg_core_window_t *w);
+static size_t           _window_list_areas             (dg_core_window_t *w, dg_core_cell_focus_t focus);
 static _area_t         *_window_seek_focus_ortho       (dg_core_window_t *w, _area_t *a_start, _focus_seek_param_t axis, _focus_seek_param_t side, _focus_seek_param_t dir);
 static _area_t         *_window_seek_focus_logic       (dg_core_window_t *w, _area_t *a_start, _focus_seek_param_t dir);
 
@@ -339,10 +549,28 @@ static int          _argc     = 0;
 
 static unsigned int _serial = 0;
 
-static dg_core_stack_t _windows = {.ptr = NULL, .n = 0, .n_alloc = 0};
-static dg_core_stack_t _grids   = {.ptr = NULL, .n = 0, .n_alloc = 0};
-static dg_core_stack_t _cells   = {.ptr = NULL, .n = 0, .n_alloc = 0};
-static dg_core_stack_t _events  = {.ptr = NULL, .n = 0, .n_alloc = 0};
+static dg_core_slotmap_t _windows = {.ptr = NULL, .n = 0, .n_alloc = 0, .n_slots = 0, .i_free = SIZE_MAX};
+static dg_core_slotmap_t _grids   = {.ptr = NULL, .n = 0, .n_alloc = 0, .n_slots = 0, .i_free = SIZE_MAX};
+static dg_core_slotmap_t _cells   = {.ptr = NULL, .n = 0, .n_alloc = 0, .n_slots = 0, .i_free = SIZE_MAX};
+static dg_core_queue_t   _events  = {.ptr = NULL, .n = 0, .n_alloc = 0, .i_head = 0};
+
+/* X window id to window lookup and count of windows with the ACTIVE state */
+
+static dg_core_map_t _windows_map      = {.slots = NULL, .n = 0, .n_alloc = 0};
+static size_t        _windows_n_active = 0;
+
+/* elements with pending changes, handled at the end of each event batch */
+
+static dg_core_stack_t _windows_dirty = {.ptr = NULL, .n = 0, .n_alloc = 0}; /* pending present   */
+static dg_core_stack_t _windows_trash = {.ptr = NULL, .n = 0, .n_alloc = 0}; /* pending destroy   */
+static dg_core_stack_t _grids_trash   = {.ptr = NULL, .n = 0, .n_alloc = 0}; /* pending destroy   */
+static dg_core_stack_t _cells_trash   = {.ptr = NULL, .n = 0, .n_alloc = 0}; /* pending destroy   */
+
+/* retained cells renderings, from the most to the least recently used, and their memory footprint */
+
+static _retained_t *_retains_head = NULL;
+static _retained_t *_retains_tail = NULL;
+static size_t       _retains_size = 0;
 
 /* popup tracking */
 
@@ -364,7 +592,33 @@ static bool (*_fn_event_preprocessor)  (xcb_generic_event_t *x_ev) = NULL;
 
 /* loop signal callback */
 
-static void (*_fn_callback_loop_signal) (uint32_t serial) = NULL;
+static void (*_fn_callback_loop_message) (uint32_t serial, void *data) = NULL;
+static void (*_fn_callback_loop_signal)  (uint32_t serial)             = NULL;
+
+/* drawing batch callback */
+
+static void (*_fn_callback_draw_batch) (cairo_t *c_ctx, bool open) = NULL;
+
+/* bounded multi-producer single-consumer message queue, filled by any thread and drained by the loop */
+
+static _message_t    _msgs[_MESSAGES_LEN];
+static atomic_size_t _msgs_tail = 0;  /* next slot to be claimed by producers  */
+static size_t        _msgs_head = 0;  /* next slot to be read by the loop      */
+static int           _msgs_fd   = -1; /* eventfd used to wake the loop up      */
+
+/* file descriptors watched by the event loop alongside the X connection */
+
+static dg_core_stack_t _fds          = {.ptr = NULL, .n = 0, .n_alloc = 0};
+static struct pollfd  *_fds_poll     = NULL; /* poll() buffer, first slot is the X connection */
+static size_t          _fds_poll_n   = 0;    /* allocated size of _fds_poll                   */
+
+/* timers, the heap is ordered by deadline and only holds running timers */
+
+static dg_core_stack_t   _timers             = {.ptr = NULL, .n = 0, .n_alloc = 0};
+static dg_core_timer_t **_timers_heap        = NULL;
+static size_t            _timers_heap_n      = 0;
+static size_t            _timers_heap_n_alloc = 0;
+static int               _timers_fd          = -1; /* timerfd armed on the earliest deadline */
 
 /* common X atoms */
 
@@ -408,10 +662,88 @@ static xcb_atom_t _xa_acl  = 0; /* DG_CORE_ATOM_ACCEL             */
 static xcb_atom_t _xa_isig = 0;                              /* "_INTERNAL_LOOP_SIGNAL"        */
 static xcb_atom_t _xa_aclx[DG_CORE_CONFIG_MAX_ACCELS] = {0}; /* "_DG_WINDOW_ACCEL_x" x = 1..12 */
 
+/* atoms interned at init, except the accelerator ones whose names are generated */
+
+static const dg_core_atom_req_t _atom_reqs[] = {
+	{ "CLIPBOARD",                      &_xa_clip },
+	{ "TIMESTAMP",                      &_xa_time },
+	{ "MULTIPLE",                       &_xa_mult },
+	{ "TARGETS",                        &_xa_trgt },
+	{ "UTF8_STRING",                    &_xa_utf8 },
+	{ "WM_PROTOCOLS",                   &_xa_prot },
+	{ "WM_DELETE_WINDOW",               &_xa_del  },
+	{ "WM_TAKE_FOCUS",                  &_xa_foc  },
+	{ "WM_NAME",                        &_xa_nam  },
+	{ "WM_ICON_NAME",                   &_xa_ico  },
+	{ "WM_CLASS",                       &_xa_cls  },
+	{ "WM_COMMAND",                     &_xa_cmd  },
+	{ "WM_CLIENT_MACHINE",              &_xa_host },
+	{ "WM_CLIENT_LEADER",               &_xa_lead },
+	{ "_NET_WM_PING",                   &_xa_ping },
+	{ "_NET_WM_PID",                    &_xa_pid  },
+	{ "_NET_WM_NAME",                   &_xa_nnam },
+	{ "_NET_WM_ICON_NAME",              &_xa_nico },
+	{ "_NET_WM_WINDOW_TYPE",            &_xa_type },
+	{ "_NET_WM_WINDOW_TYPE_DESKTOP",    &_xa_fix  },
+	{ "_INTERNAL_LOOP_SIGNAL",          &_xa_isig },
+	{ DG_CORE_ATOM_SIGNALS,             &_xa_sig  },
+	{ DG_CORE_ATOM_VERSION,             &_xa_vers },
+	{ DG_CORE_ATOM_WINDOW_STATES,       &_xa_stt  },
+	{ DG_CORE_ATOM_WINDOW_FOCUS,        &_xa_dfoc },
+	{ DG_CORE_ATOM_PASTE_TMP_1,         &_xa_tmp1 },
+	{ DG_CORE_ATOM_PASTE_TMP_2,         &_xa_tmp2 },
+	{ DG_CORE_ATOM_PASTE_TMP_3,         &_xa_tmp3 },
+	{ DG_CORE_ATOM_WINDOW_ACTIVE,       &_xa_won  },
+	{ DG_CORE_ATOM_WINDOW_DISABLED,     &_xa_wena },
+	{ DG_CORE_ATOM_WINDOW_GRID_LOCK,    &_xa_plck },
+	{ DG_CORE_ATOM_WINDOW_FOCUS_LOCK,   &_xa_flck },
+	{ DG_CORE_ATOM_RECONFIG,            &_xa_conf },
+	{ DG_CORE_ATOM_ACCEL,               &_xa_acl  },
+};
+
 /* extensions op codes */
 
 static uint8_t _x_opc_present = 0;
 static uint8_t _x_opc_xinput  = 0;
+static uint8_t _x_evt_shm     = 0; /* first event code of MIT-SHM, 0 if the backend is not used */
+
+/* render worker pool, the loop thread takes part in each round so render_threads - 1 workers get spawned */
+
+static pthread_t       *_pool_threads      = NULL;
+static size_t           _pool_n            = 0;    /* spawned workers                              */
+static unsigned int     _pool_size         = 0;    /* render_threads value the pool was started for */
+static pthread_mutex_t  _pool_mutex        = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t   _pool_cond_work    = PTHREAD_COND_INITIALIZER; /* new round or shutdown   */
+static pthread_cond_t   _pool_cond_done    = PTHREAD_COND_INITIALIZER; /* last worker is done     */
+static unsigned long    _pool_round        = 0;
+static size_t           _pool_busy         = 0;    /* workers still in the current round           */
+static bool             _pool_quit         = false;
+static cairo_surface_t *_pool_c_srf        = NULL; /* image surface the current round draws to     */
+static _area_job_t     *_pool_jobs         = NULL;
+static size_t           _pool_jobs_n       = 0;
+static size_t           _pool_jobs_n_alloc = 0;
+static atomic_size_t    _pool_jobs_next    = 0;    /* next job to be claimed                       */
+
+/* scratch list of the areas of one focus tier to draw next, see _window_list_areas() */
+
+static _area_t **_draws         = NULL;
+static size_t    _draws_n_alloc = 0;
+
+/* render thread, it draws the areas of one window frame at a time while the loop keeps handling events */
+
+static pthread_t       _render_thread;
+static bool            _render_running = false;
+static bool            _render_quit    = false;
+static atomic_bool     _render_abort   = false; /* tells the thread to leave the remaining cells to the loop */
+static _Atomic(dg_core_cell_t*) _render_blocked = NULL; /* cell the thread waits on, see _render_lock_cell() */
+static pthread_mutex_t _render_mutex   = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  _render_cond    = PTHREAD_COND_INITIALIZER; /* frame handed off, drawn, or shutdown */
+static int             _render_fd      = -1;    /* eventfd signaled once a frame is drawn                */
+static _frame_t        _frame          = {0};
+
+/* active rendering backend, falls back to XCB if MIT-SHM is requested but can't be used */
+
+static dg_core_config_render_backend_t _render_backend = DG_CORE_CONFIG_RENDER_XCB;
 
 /* selection data, respectively : clipboard, primary and secondary */
 
@@ -422,6 +754,16 @@ static xcb_atom_t   _sel_targets[4] = {0};
 /* PUBLIC - MAIN ********************************************************************************************/
 /************************************************************************************************************/
 
+dg_core_config_render_backend_t
+dg_core_get_render_backend(void)
+{
+	_IS_INIT;
+
+	return _render_backend;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 unsigned int
 dg_core_get_serial(void)
 {
@@ -432,6 +774,35 @@ dg_core_get_serial(void)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+xcb_atom_t
+dg_core_get_xcb_atom(const char *name)
+{
+	assert(name);
+
+	char s[20];
+
+	if (!_init) {
+		return XCB_ATOM_NONE;
+	}
+
+	for (size_t i = 0; i < sizeof(_atom_reqs) / sizeof(dg_core_atom_req_t); i++) {
+		if (strcmp(name, _atom_reqs[i].name) == 0) {
+			return *_atom_reqs[i].atom;
+		}
+	}
+
+	for (size_t i = 0; i < DG_CORE_CONFIG_MAX_ACCELS; i++) {
+		sprintf(s, DG_CORE_ATOM_ACCEL "_%zu", i + 1);
+		if (strcmp(name, s) == 0) {
+			return _xa_aclx[i];
+		}
+	}
+
+	return XCB_ATOM_NONE;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 xcb_connection_t *
 dg_core_get_xcb_connection(void)
 {
@@ -455,13 +826,24 @@ dg_core_init(int argc, char *const *argv, const char *class_name, const char *cl
 	assert(!_init);
 
 	xcb_void_cookie_t xc;
+	xcb_void_cookie_t xc2;
 
 	/* init structs */
 
-	dg_core_stack_init(&_windows, 0);
-	dg_core_stack_init(&_grids,   0);
-	dg_core_stack_init(&_cells,   0);
-	dg_core_stack_init(&_events,  0);
+	dg_core_slotmap_init(&_windows, 0);
+	dg_core_slotmap_init(&_grids,   0);
+	dg_core_slotmap_init(&_cells,   0);
+	dg_core_queue_init(&_events,    0);
+
+	dg_core_map_init(&_windows_map, 0);
+
+	dg_core_stack_init(&_windows_dirty, 0);
+	dg_core_stack_init(&_windows_trash, 0);
+	dg_core_stack_init(&_grids_trash,   0);
+	dg_core_stack_init(&_cells_trash,   0);
+
+	dg_core_stack_init(&_fds,    0);
+	dg_core_stack_init(&_timers, 0);
 
 	/* load config */
 
@@ -536,49 +918,32 @@ dg_core_init(int argc, char *const *argv, const char *class_name, const char *cl
 		goto err_crit;
 	}
 
-	/* get atoms */
-
-	_xa_clip = _x_get_atom("CLIPBOARD");
-	_xa_time = _x_get_atom("TIMESTAMP");
-	_xa_mult = _x_get_atom("MULTIPLE");
-	_xa_trgt = _x_get_atom("TARGETS");
-	_xa_utf8 = _x_get_atom("UTF8_STRING");
-	_xa_prot = _x_get_atom("WM_PROTOCOLS");
-	_xa_del  = _x_get_atom("WM_DELETE_WINDOW");
-	_xa_foc  = _x_get_atom("WM_TAKE_FOCUS");
-	_xa_nam  = _x_get_atom("WM_NAME");
-	_xa_ico  = _x_get_atom("WM_ICON_NAME");
-	_xa_cls  = _x_get_atom("WM_CLASS");
-	_xa_cmd  = _x_get_atom("WM_COMMAND");
-	_xa_host = _x_get_atom("WM_CLIENT_MACHINE");
-	_xa_lead = _x_get_atom("WM_CLIENT_LEADER");
-	_xa_ping = _x_get_atom("_NET_WM_PING");
-	_xa_pid  = _x_get_atom("_NET_WM_PID");
-	_xa_nnam = _x_get_atom("_NET_WM_NAME");
-	_xa_nico = _x_get_atom("_NET_WM_ICON_NAME");
-	_xa_type = _x_get_atom("_NET_WM_WINDOW_TYPE");
-	_xa_fix  = _x_get_atom("_NET_WM_WINDOW_TYPE_DESKTOP");
-	_xa_isig = _x_get_atom("_INTERNAL_LOOP_SIGNAL");
-	_xa_sig  = _x_get_atom(DG_CORE_ATOM_SIGNALS);
-	_xa_vers = _x_get_atom(DG_CORE_ATOM_VERSION);
-	_xa_stt  = _x_get_atom(DG_CORE_ATOM_WINDOW_STATES);
-	_xa_dfoc = _x_get_atom(DG_CORE_ATOM_WINDOW_FOCUS);
-	_xa_tmp1 = _x_get_atom(DG_CORE_ATOM_PASTE_TMP_1);
-	_xa_tmp2 = _x_get_atom(DG_CORE_ATOM_PASTE_TMP_2);
-	_xa_tmp3 = _x_get_atom(DG_CORE_ATOM_PASTE_TMP_3);
-	_xa_won  = _x_get_atom(DG_CORE_ATOM_WINDOW_ACTIVE);
-	_xa_wena = _x_get_atom(DG_CORE_ATOM_WINDOW_DISABLED);
-	_xa_plck = _x_get_atom(DG_CORE_ATOM_WINDOW_GRID_LOCK);
-	_xa_flck = _x_get_atom(DG_CORE_ATOM_WINDOW_FOCUS_LOCK);
-	_xa_conf = _x_get_atom(DG_CORE_ATOM_RECONFIG);
-	_xa_acl  = _x_get_atom(DG_CORE_ATOM_ACCEL);
+	/* send the extension queries, then intern all atoms in one go, and only then wait for the replies */
 
-	char s[20];
-	for (int i = 0; i < sizeof(_xa_aclx) / sizeof(xcb_atom_t); i++) {
-		sprintf(s, DG_CORE_ATOM_ACCEL "_%i", i + 1);
-		_xa_aclx[i] = _x_get_atom(s);
+	xcb_query_extension_cookie_t xc_present = xcb_query_extension(_x_con, strlen("Present"), "Present");
+	xcb_query_extension_cookie_t xc_xinput  = xcb_query_extension(_x_con, strlen("XInputExtension"), "XInputExtension");
+
+	if (DG_CORE_CONFIG->render_backend == DG_CORE_CONFIG_RENDER_SHM) {
+		xcb_prefetch_extension_data(_x_con, &xcb_shm_id);
+	}
+
+	const size_t n_reqs = sizeof(_atom_reqs) / sizeof(dg_core_atom_req_t);
+
+	dg_core_atom_req_t reqs[sizeof(_atom_reqs) / sizeof(dg_core_atom_req_t) + DG_CORE_CONFIG_MAX_ACCELS];
+	char               reqs_aclx[DG_CORE_CONFIG_MAX_ACCELS][20];
+
+	for (size_t i = 0; i < n_reqs; i++) {
+		reqs[i] = _atom_reqs[i];
+	}
+
+	for (size_t i = 0; i < DG_CORE_CONFIG_MAX_ACCELS; i++) {
+		sprintf(reqs_aclx[i], DG_CORE_ATOM_ACCEL "_%zu", i + 1);
+		reqs[n_reqs + i].name = reqs_aclx[i];
+		reqs[n_reqs + i].atom = &_xa_aclx[i];
 	}
 
+	_x_get_atoms(reqs, n_reqs + DG_CORE_CONFIG_MAX_ACCELS);
+
 	_sel_targets[0] = _xa_trgt;
 	_sel_targets[1] = _xa_time;
 	_sel_targets[2] = _xa_mult;
@@ -586,8 +951,20 @@ dg_core_init(int argc, char *const *argv, const char *class_name, const char *cl
 
 	/* get extensions opcodes */
 
-	_x_opc_present = _x_get_extension_opcode("Present");
-	_x_opc_xinput  = _x_get_extension_opcode("XInputExtension");
+	_x_opc_present = _x_get_extension_opcode(xc_present);
+	_x_opc_xinput  = _x_get_extension_opcode(xc_xinput);
+
+	/* pick the rendering backend, whether MIT-SHM segments can actually be shared with the server (which */
+	/* is not the case over a network) is only known once the first window tries to attach one           */
+
+	_render_backend = DG_CORE_CONFIG_RENDER_XCB;
+	if (DG_CORE_CONFIG->render_backend == DG_CORE_CONFIG_RENDER_SHM) {
+		const xcb_query_extension_reply_t *x_ext = xcb_get_extension_data(_x_con, &xcb_shm_id);
+		if (x_ext && x_ext->present) {
+			_render_backend = DG_CORE_CONFIG_RENDER_SHM;
+			_x_evt_shm      = x_ext->first_event;
+		}
+	}
 
 	/* get colormap to create transparent windows */
 
@@ -599,8 +976,6 @@ dg_core_init(int argc, char *const *argv, const char *class_name, const char *cl
 		_x_scr->root,
 		_x_vis->visual_id);
 
-	_x_test_cookie(xc, true);
-
 	/* create leader window */
 
 	const uint32_t mask_vals[] = {
@@ -610,7 +985,7 @@ dg_core_init(int argc, char *const *argv, const char *class_name, const char *cl
 	};
 
 	_x_win_l = xcb_generate_id(_x_con);
-	xc = xcb_create_window_checked(
+	xc2 = xcb_create_window_checked(
 		_x_con,
 		XCB_COPY_FROM_PARENT,
 		_x_win_l,
@@ -623,7 +998,8 @@ dg_core_init(int argc, char *const *argv, const char *class_name, const char *cl
 		XCB_CW_EVENT_MASK,
 		mask_vals);
 
-	_x_test_cookie(xc, true);
+	_x_test_cookie(xc,  true);
+	_x_test_cookie(xc2, true);
 
 	/* set leader window properties */
 
@@ -652,6 +1028,21 @@ dg_core_init(int argc, char *const *argv, const char *class_name, const char *cl
 
 	_init = true;	
 
+	/* setup the cross-thread message queue, DG remains usable without it */
+
+	for (size_t i = 0; i < _MESSAGES_LEN; i++) {
+		atomic_init(&_msgs[i].seq, i);
+	}
+	atomic_init(&_msgs_tail, 0);
+
+	_msgs_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_msgs_fd < 0) {
+		dg_core_errno_set(DG_CORE_ERRNO_DEPENDENCY);
+	} else if (!dg_core_loop_add_fd(_msgs_fd, POLLIN, _loop_process_messages)) {
+		close(_msgs_fd);
+		_msgs_fd = -1;
+	}
+
 	return;	
 
 	/* errors */
@@ -685,6 +1076,13 @@ dg_core_reconfig(void)
 void 
 dg_core_reset(void)
 {
+	/* stop render threads */
+
+	_render_stop();
+	_pool_stop();
+	free(_pool_jobs);
+	free(_draws);
+
 	/* disconnect from x server */
 	
 	if (_x_ksm) {
@@ -705,10 +1103,56 @@ dg_core_reset(void)
 	_p_last  = NULL;
 	_p_hover = NULL;
 
-	dg_core_stack_reset(&_windows);
-	dg_core_stack_reset(&_grids);
-	dg_core_stack_reset(&_cells);
-	dg_core_stack_reset(&_events);
+	dg_core_slotmap_reset(&_windows);
+	dg_core_slotmap_reset(&_grids);
+	dg_core_slotmap_reset(&_cells);
+	while (_events.n > 0) {
+		free((void*)dg_core_queue_pop(&_events));
+	}
+
+	dg_core_queue_reset(&_events);
+
+	dg_core_map_reset(&_windows_map);
+	_windows_n_active = 0;
+
+	for (_retained_t *r = _retains_head, *r_next; r; r = r_next) {
+		r_next = r->next;
+		if (r->c_srf) {
+			cairo_surface_destroy(r->c_srf);
+		}
+		free(r);
+	}
+
+	_retains_head = NULL;
+	_retains_tail = NULL;
+	_retains_size = 0;
+
+	dg_core_stack_reset(&_windows_dirty);
+	dg_core_stack_reset(&_windows_trash);
+	dg_core_stack_reset(&_grids_trash);
+	dg_core_stack_reset(&_cells_trash);
+
+	for (size_t i = 0; i < _fds.n; i++) {
+		free((_fd_watch_t*)_fds.ptr[i]);
+	}
+
+	dg_core_stack_reset(&_fds);
+	free(_fds_poll);
+
+	for (size_t i = 0; i < _timers.n; i++) {
+		free((dg_core_timer_t*)_timers.ptr[i]);
+	}
+
+	dg_core_stack_reset(&_timers);
+	free(_timers_heap);
+
+	if (_timers_fd >= 0) {
+		close(_timers_fd);
+	}
+
+	if (_msgs_fd >= 0) {
+		close(_msgs_fd);
+	}
 
 	/* reset the config */
 
@@ -744,13 +1188,36 @@ dg_core_reset(void)
 
 	_x_opc_present = 0;
 	_x_opc_xinput  = 0;
+	_x_evt_shm     = 0;
+
+	_render_backend = DG_CORE_CONFIG_RENDER_XCB;
 
 	_ext_x = false;
 	_loop  = false;
 
-	_fn_event_postprocessor  = NULL;
-	_fn_event_preprocessor   = NULL;
-	_fn_callback_loop_signal = NULL;
+	_fn_event_postprocessor   = NULL;
+	_fn_event_preprocessor    = NULL;
+	_fn_callback_loop_message = NULL;
+	_fn_callback_loop_signal  = NULL;
+	_fn_callback_draw_batch   = NULL;
+
+	_pool_jobs         = NULL;
+	_pool_jobs_n       = 0;
+	_pool_jobs_n_alloc = 0;
+
+	_draws         = NULL;
+	_draws_n_alloc = 0;
+
+	_msgs_head = 0;
+	_msgs_fd   = -1;
+
+	_fds_poll   = NULL;
+	_fds_poll_n = 0;
+
+	_timers_heap         = NULL;
+	_timers_heap_n       = 0;
+	_timers_heap_n_alloc = 0;
+	_timers_fd           = -1;
 
 	_xa_clip = 0;
 	_xa_time = 0;
@@ -800,6 +1267,14 @@ dg_core_reset(void)
 	_init = false;
 }
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_core_set_callback_draw_batch(void (*fn)(cairo_t *c_ctx, bool open))
+{
+	_fn_callback_draw_batch = fn;
+}
+
 /************************************************************************************************************/
 /* PUBLIC - LOOP ********************************************************************************************/
 /************************************************************************************************************/
@@ -814,6 +1289,43 @@ dg_core_loop_abort(void)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+bool
+dg_core_loop_add_fd(int fd, short events, void (*fn)(int fd, short revents))
+{
+	_IS_INIT;
+	assert(fd >= 0 && fn);
+
+	/* if the file descriptor is already watched, only update its parameters */
+
+	_fd_watch_t *fw = _loop_find_fd(fd);
+	if (fw) {
+		fw->events = events;
+		fw->fn     = fn;
+		return true;
+	}
+
+	/* otherwhise create a new watch */
+
+	fw = malloc(sizeof(_fd_watch_t));
+	if (!fw) {
+		dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+		return false;
+	}
+
+	fw->fd     = fd;
+	fw->events = events;
+	fw->fn     = fn;
+
+	if (!dg_core_stack_push(&_fds, fw, NULL)) {
+		free(fw);
+		return false;
+	}
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 void
 dg_core_loop_allow_user_exit(void)
 {
@@ -830,6 +1342,22 @@ dg_core_loop_block_user_exit(void)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+void
+dg_core_loop_remove_fd(int fd)
+{
+	_IS_INIT;
+
+	_fd_watch_t *fw = _loop_find_fd(fd);
+	if (!fw) {
+		return;
+	}
+
+	dg_core_stack_pull(&_fds, fw);
+	free(fw);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 void
 dg_core_loop_run(void)
 {
@@ -842,129 +1370,40 @@ dg_core_loop_run(void)
 
 	while (_init && _loop && !_loop_no_active_windows()) {
 
-		/* grab next event from stack buffer if any, otherwhise retrieve new event from server */
-
-		if (_events.n > 0) {
-			x_ev = (xcb_generic_event_t*)_events.ptr[0];
-			dg_core_stack_pull(&_events, x_ev);
-		} else {
-			x_ev = xcb_wait_for_event(_x_con);
-			if (!x_ev) {
-				dg_core_errno_set(DG_CORE_ERRNO_XCB);
-				break;
-			}
-		}
-
-		/* extra user's pre-event processor */
-
-		_RUN_INT_FN(_fn_event_preprocessor, goto skip_events, x_ev);
+		/* wait for new events if the buffer is empty, then grab everything that's already been queued */
 
-		/* error events */
-
-		if (x_ev->response_type == 0) {
+		if (!_loop_fill_events()) {
 			dg_core_errno_set(DG_CORE_ERRNO_XCB);
-			goto skip_events;
+			break;
 		}
 
-		/* built-in event processors */
-
-		switch (x_ev->response_type & ~0x80) {
-
-			/* can mix key and button_press events because their structs have the same fields */
-
-			case XCB_BUTTON_PRESS:
-			case XCB_BUTTON_RELEASE:
-			case XCB_KEY_PRESS:
-			case XCB_KEY_RELEASE:
-				_event_core_input((xcb_key_press_event_t*)x_ev);
-				break;
-
-			case XCB_LEAVE_NOTIFY:
-				_event_leave((xcb_leave_notify_event_t*)x_ev);
-				break;
-
-			case XCB_UNMAP_NOTIFY:
-				_event_unmap((xcb_unmap_notify_event_t*)x_ev);
-				break;
-
-			case XCB_MAP_NOTIFY:
-				_event_map((xcb_map_notify_event_t*)x_ev);
-				break;
-
-			case XCB_EXPOSE:
-				_event_expose((xcb_expose_event_t*)x_ev);
-				break;
-
-			case XCB_MOTION_NOTIFY:
-				_event_motion((xcb_motion_notify_event_t*)x_ev);
-				break;
-
-			case XCB_FOCUS_IN:
-				_event_focus_in((xcb_focus_in_event_t*)x_ev);
-				break;
-
-			case XCB_FOCUS_OUT:
-				_event_focus_out((xcb_focus_in_event_t*)x_ev);
-				break;
-
-			case XCB_CLIENT_MESSAGE:
-				_event_client_message((xcb_client_message_event_t*)x_ev);
-				break;
-
-			case XCB_CONFIGURE_NOTIFY:
-				_event_configure((xcb_configure_notify_event_t*)x_ev);
-				break;
+		/* messages and watched file descriptors (timers, frame completions, user fds) are also checked on */
+		/* each batch so that a busy X connection cannot starve them                                       */
 
-			case XCB_VISIBILITY_NOTIFY:
-				_event_visibility((xcb_visibility_notify_event_t*)x_ev);
-				break;
-
-			case XCB_MAPPING_NOTIFY:
-				_event_keymap((xcb_mapping_notify_event_t*)x_ev);
-				break;
-
-			case XCB_SELECTION_CLEAR:
-				_event_selection_clear((xcb_selection_clear_event_t*)x_ev);
-				break;
-
-			case XCB_SELECTION_REQUEST:
-				_event_selection_request((xcb_selection_request_event_t*)x_ev);
-				break;
+		_loop_process_messages(-1, 0);
+		_loop_poll_fds(0);
 
-			case XCB_GE_GENERIC:
-				if (((xcb_ge_generic_event_t*)x_ev)->extension == _x_opc_present) {
-					_event_present((xcb_present_generic_event_t*)x_ev);
-				} else if (((xcb_ge_generic_event_t*)x_ev)->extension == _x_opc_xinput) {
-					_event_xinput_touch((xcb_input_touch_begin_event_t*)x_ev);
-				}
-				break;
+		if (_init && DG_CORE_CONFIG->input_coalesce) {
+			_loop_coalesce_events();
 		}
 
-skip_events:
+		/* process buffered events in order */
 
-		/* extra user's post-event processor */
+		while (_init && _loop && _events.n > 0 && !_loop_no_active_windows()) {
 
-		_RUN_FN(_fn_event_postprocessor, x_ev);
+			x_ev = (xcb_generic_event_t*)dg_core_queue_pop(&_events);
 
-		/* prepare window's visual update and destroy things that needs it */
+			_loop_dispatch_event(x_ev);
 
-		for (size_t i = _windows.n; i > 0; i--) {
-			_window_present((dg_core_window_t*)_windows.ptr[i - 1]);
-			_window_destroy((dg_core_window_t*)_windows.ptr[i - 1]);
+			free(x_ev);
 		}
 
-		for (size_t i = _grids.n; i > 0; i--) {
-			_grid_destroy((dg_core_grid_t*)_grids.ptr[i - 1]);
-		}
+		/* prepare window's visual update and destroy things that needs it, once per batch */
 
-		for (size_t i = _cells.n; i > 0; i--) {
-			_cell_destroy((dg_core_cell_t*)_cells.ptr[i - 1]);
+		if (_init) {
+			_loop_run_epilogue();
+			xcb_flush(_x_con);
 		}
-
-		/* cleaning for next event */
-		
-		free(x_ev);
-		xcb_flush(_x_con);
 	}
 
 	_loop = false;
@@ -972,6 +1411,16 @@ skip_events:
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+void
+dg_core_loop_set_callback_message(void (*fn)(uint32_t serial, void *data))
+{
+	_IS_INIT;
+
+	_fn_callback_loop_message = fn;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 void
 dg_core_loop_set_callback_signal(void (*fn)(uint32_t serial))
 {
@@ -1003,26 +1452,21 @@ dg_core_loop_set_event_preprocessor(bool (*fn)(xcb_generic_event_t *x_ev))
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 bool
-dg_core_loop_send_signal(uint32_t serial)
+dg_core_loop_send_message(uint32_t serial, void *data)
 {
 	_IS_INIT;
 
-	xcb_client_message_data_t x_data = {.data32 = {serial}};
-	xcb_client_message_event_t x_ev = {
-		.response_type = XCB_CLIENT_MESSAGE,
-		.format   = 32,
-		.sequence = 0,
-		.window   = _x_win_l,
-		.type     = _xa_isig,
-		.data     = x_data};
+	return _loop_push_message(false, serial, data);
+}
 
-	_x_test_cookie(
-		xcb_send_event_checked(_x_con, 0, _x_win_l, XCB_EVENT_MASK_NO_EVENT, (char*)&x_ev),
-		true);
-	
-	xcb_flush(_x_con);
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-	return true;
+bool
+dg_core_loop_send_signal(uint32_t serial)
+{
+	_IS_INIT;
+
+	return _loop_push_message(true, serial, NULL);
 }
 
 /************************************************************************************************************/
@@ -1129,9 +1573,13 @@ dg_core_window_destroy(dg_core_window_t *w)
 	_IS_INIT;
 	_IS_WINDOW(w);
 
+	if (w->to_destroy) {
+		return;
+	}
+
 	w->to_destroy = true;
 
-	if (!_loop) {
+	if (!_loop || !dg_core_stack_append(&_windows_trash, w, NULL)) {
 		_window_destroy(w);
 	}
 }
@@ -1205,6 +1653,17 @@ dg_core_window_get_current_grid(dg_core_window_t *w)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+unsigned long
+dg_core_window_get_missed_frames(dg_core_window_t *w)
+{
+	_IS_INIT;
+	_IS_WINDOW(w);
+
+	return w->missed;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 int16_t
 dg_core_window_get_pixel_height(dg_core_window_t *w)
 {
@@ -1292,6 +1751,7 @@ dg_core_window_pull_grid(dg_core_window_t *w, dg_core_grid_t *g)
 	dg_core_stack_pull(&w->grids, g);
 	_window_update_wm_size_hints(w);
 	g->used = false;
+	g->w_parent = NULL;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -1311,6 +1771,7 @@ dg_core_window_push_grid(dg_core_window_t *w, dg_core_grid_t *g)
 	dg_core_stack_push(&w->grids, g, NULL);
 	_window_update_wm_size_hints(w);
 	g->used = true;
+	g->w_parent = w;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -1522,7 +1983,18 @@ dg_core_window_set_fixed_position(dg_core_window_t *w, int16_t px, int16_t py)
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 void
-dg_core_window_swap_grid(dg_core_window_t *w, dg_core_grid_t *g1, dg_core_grid_t *g2)
+dg_core_window_set_low_latency(dg_core_window_t *w, bool low_latency)
+{
+	_IS_INIT;
+	_IS_WINDOW(w);
+
+	w->low_latency = low_latency;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_core_window_swap_grid(dg_core_window_t *w, dg_core_grid_t *g1, dg_core_grid_t *g2)
 {
 	_IS_INIT;
 	_IS_WINDOW(w);
@@ -1541,6 +2013,9 @@ dg_core_window_swap_grid(dg_core_window_t *w, dg_core_grid_t *g1, dg_core_grid_t
 	g1->used = false;
 	g2->used = true;
 
+	g1->w_parent = NULL;
+	g2->w_parent = w;
+
 	/* extra operations for when the swap happens when the swapped grid is visible */
 
 	if (w->g_current != g1) {
@@ -1677,21 +2152,43 @@ dg_core_grid_assign_cell(dg_core_grid_t *g, dg_core_cell_t *c, int16_t cx, int16
 	}
 
 	a->redraw = false;
+	a->dirty_id = SIZE_MAX;
+	a->clip = (_rect_t){0, 0, 0, 0};
+	a->wake_w = NULL;
+	a->wake_id = SIZE_MAX;
+	a->wake = 0;
+	a->wake_clip = (_rect_t){0, 0, 0, 0};
 	a->g_parent = g;
 	a->c  = c;
 	a->cx = cx;
 	a->cy = cy;
 	a->cw = cw;
 	a->ch = ch;
-	a->id = 0;
 
 	if (!dg_core_input_buffer_init(&a->touches, DG_CORE_INPUT_BUFFER_MAX_TOUCHES, DG_CORE_INPUT_BUFFER_COORD)) {
 		goto fail_buf_init;
 	}
 
-	if (!dg_core_stack_push(&g->areas, a, &a->id)) {
+	if (!dg_core_slotmap_push(&g->areas, a, &a->id)) {
 		goto fail_push;
 	}
+
+	/* the dirty set is sized to hold every area of the grid, so that marking an area never fails  */
+	/* it follows the geometric growth of the areas slotmap instead of being resized on every push */
+
+	if (g->n_dirty_alloc < g->areas.n_alloc) {
+		_area_t **dirty = realloc(g->dirty, g->areas.n_alloc * sizeof(_area_t*));
+		if (!dirty) {
+			dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+			goto fail_push_dirty;
+		}
+		g->dirty = dirty;
+		g->n_dirty_alloc = g->areas.n_alloc;
+	}
+
+	if (!dg_core_slotmap_push(&c->areas, a, &a->id_cell)) {
+		goto fail_push_cell;
+	}
 	
 	/* send assign event to newly created area */
 
@@ -1705,6 +2202,9 @@ dg_core_grid_assign_cell(dg_core_grid_t *g, dg_core_cell_t *c, int16_t cx, int16
 
 	/* errors */
 
+fail_push_cell:
+fail_push_dirty:
+	dg_core_slotmap_pull(&g->areas, a->id);
 fail_push:
 	dg_core_input_buffer_reset(&a->touches);
 fail_buf_init:
@@ -1762,7 +2262,11 @@ dg_core_grid_create(int16_t cw, int16_t ch)
 		goto fail_alloc;
 	}
 
-	g->areas = DG_CORE_STACK_EMPTY;
+	g->areas = DG_CORE_SLOTMAP_EMPTY;
+	g->dirty = NULL;
+	g->n_dirty = 0;
+	g->n_dirty_alloc = 0;
+	g->w_parent = NULL;
 	g->g_ref = NULL;
 	g->used = false;
 	g->cw = cw;
@@ -1773,8 +2277,9 @@ dg_core_grid_create(int16_t cw, int16_t ch)
 	g->n_chu = ch;
 	g->n_cwu_inv = 0;
 	g->n_chu_inv = 0;
+	g->fxo_n = INT16_MIN;
+	g->fyo_n = INT16_MIN;
 	g->to_destroy = false;
-	g->id = 0;
 
 	g->cwu = NULL;
 	g->chu = NULL;
@@ -1785,13 +2290,17 @@ dg_core_grid_create(int16_t cw, int16_t ch)
 	g->chu = calloc(ch, sizeof(int16_t));
 	g->fwu = calloc(cw, sizeof(double));
 	g->fhu = calloc(ch, sizeof(double));
+	g->pxo = calloc(cw + 1, sizeof(int16_t));
+	g->pyo = calloc(ch + 1, sizeof(int16_t));
+	g->fxo = calloc(cw + 1, sizeof(int16_t));
+	g->fyo = calloc(ch + 1, sizeof(int16_t));
 
-	if (!g->chu || !g->cwu || !g->fhu || !g->fwu) {
+	if (!g->chu || !g->cwu || !g->fhu || !g->fwu || !g->pxo || !g->pyo || !g->fxo || !g->fyo) {
 		dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
 		goto fail_sub_alloc;
 	}
 
-	if (!dg_core_stack_push(&_grids, g, &g->id)) {
+	if (!dg_core_slotmap_push(&_grids, g, &g->id)) {
 		goto fail_push;
 	}
 
@@ -1813,6 +2322,10 @@ fail_sub_alloc:
 	free(g->chu);
 	free(g->fwu);
 	free(g->fhu);
+	free(g->pxo);
+	free(g->pyo);
+	free(g->fxo);
+	free(g->fyo);
 	free(g);
 fail_alloc:
 	return NULL;
@@ -1826,9 +2339,13 @@ dg_core_grid_destroy(dg_core_grid_t *g)
 	_IS_INIT;
 	_IS_GRID(g);
 
+	if (g->to_destroy) {
+		return;
+	}
+
 	g->to_destroy = true;
 
-	if (!_loop) {
+	if (!_loop || !dg_core_stack_append(&_grids_trash, g, NULL)) {
 		_grid_destroy(g);
 	}
 }
@@ -1873,6 +2390,7 @@ dg_core_grid_set_column_growth(dg_core_grid_t *g, int16_t cx, double growth)
 
 	g->n_fwu  += growth - g->fwu[cx];
 	g->fwu[cx] = growth;
+	g->fxo_n   = INT16_MIN;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -1939,6 +2457,7 @@ dg_core_grid_set_row_growth(dg_core_grid_t *g, int16_t cy, double growth)
 
 	g->n_fhu  += growth - g->fhu[cy];
 	g->fhu[cy] = growth;
+	g->fyo_n   = INT16_MIN;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -2077,13 +2596,34 @@ dg_core_cell_create(
 	c->props      = props;
 	c->ena        = true;
 	c->to_destroy = false;
-	c->id         = 0;
+	c->retained   = false;
+	c->retains    = DG_CORE_STACK_EMPTY;
+	c->areas      = DG_CORE_SLOTMAP_EMPTY;
+	c->threaded   = false;
 
 	c->fn_draw    = fn_draw;
 	c->fn_event   = fn_event;
 	c->fn_destroy = fn_destroy;
 
-	if (!dg_core_stack_push(&_cells, c, &c->id)) {
+	/* recursive so that a cell's event handler can use setters that lock the cell too */
+
+	pthread_mutexattr_t attr;
+
+	if (pthread_mutexattr_init(&attr) != 0) {
+		dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+		goto fail_attr;
+	}
+
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	const bool mutex_ok = pthread_mutex_init(&c->mutex, &attr) == 0;
+	pthread_mutexattr_destroy(&attr);
+
+	if (!mutex_ok) {
+		dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+		goto fail_attr;
+	}
+
+	if (!dg_core_slotmap_push(&_cells, c, &c->id)) {
 		goto fail_push;
 	}
 
@@ -2092,6 +2632,8 @@ dg_core_cell_create(
 	/* errors */
 
 fail_push:
+	pthread_mutex_destroy(&c->mutex);
+fail_attr:
 	free(c);
 fail_alloc:
 	return NULL;
@@ -2105,9 +2647,13 @@ dg_core_cell_destroy(dg_core_cell_t *c)
 	_IS_INIT;
 	_IS_CELL(c);
 
+	if (c->to_destroy) {
+		return;
+	}
+
 	c->to_destroy = true;
 
-	if (!_loop) {
+	if (!_loop || !dg_core_stack_append(&_cells_trash, c, NULL)) {
 		_cell_destroy(c);
 	}
 }
@@ -2208,6 +2754,17 @@ dg_core_cell_is_enabled(dg_core_cell_t *c)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+void
+dg_core_cell_lock(dg_core_cell_t *c)
+{
+	_IS_INIT;
+	_IS_CELL(c);
+
+	pthread_mutex_lock(&c->mutex);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 void
 dg_core_cell_redraw(dg_core_cell_t *c)
 {
@@ -2217,22 +2774,54 @@ dg_core_cell_redraw(dg_core_cell_t *c)
 	dg_core_window_t *w;
 	_area_t *a;
 
-	for (size_t i = 0; i < _windows.n; i++) {
-		
-		w = (dg_core_window_t*)_windows.ptr[i];
-		if (!(w->state & DG_CORE_WINDOW_STATE_ACTIVE)) {
+	_retain_clear(c);
+
+	/* only areas of grids that are currently displayed by an active window are concerned */
+
+	for (size_t i = 0; i < c->areas.n; i++) {
+
+		a = (_area_t*)c->areas.ptr[i];
+		w = a->g_parent->w_parent;
+		if (!w || w->g_current != a->g_parent || !(w->state & DG_CORE_WINDOW_STATE_ACTIVE)) {
 			continue;
 		}
 
+		_area_request_redraw(a, NULL);
 		_window_set_render_level(w, _WINDOW_RENDER_AREAS);
 		_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
+	}
+}
 
-		for (size_t j = 0; j < w->g_current->areas.n; j++) {
-			a = (_area_t*)w->g_current->areas.ptr[j];
-			if (a->c == c) {
-				a->redraw = true;
-			}
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_core_cell_redraw_region(dg_core_cell_t *c, int16_t px, int16_t py, int16_t pw, int16_t ph)
+{
+	_IS_INIT;
+	_IS_CELL(c);
+
+	if (pw <= 0 || ph <= 0) {
+		return;
+	}
+
+	const _rect_t region = {px, py, pw, ph};
+
+	dg_core_window_t *w;
+	_area_t *a;
+
+	_retain_clear(c);
+
+	for (size_t i = 0; i < c->areas.n; i++) {
+
+		a = (_area_t*)c->areas.ptr[i];
+		w = a->g_parent->w_parent;
+		if (!w || w->g_current != a->g_parent || !(w->state & DG_CORE_WINDOW_STATE_ACTIVE)) {
+			continue;
 		}
+
+		_area_request_redraw(a, &region);
+		_window_set_render_level(w, _WINDOW_RENDER_AREAS);
+		_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
 	}
 }
 
@@ -2256,6 +2845,31 @@ dg_core_cell_send_custom_event(dg_core_cell_t *c, unsigned int id, void *data, s
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+void
+dg_core_cell_set_retained(dg_core_cell_t *c, bool retained)
+{
+	_IS_INIT;
+	_IS_CELL(c);
+
+	c->retained = retained;
+	if (!retained) {
+		_retain_clear(c);
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_core_cell_set_threaded(dg_core_cell_t *c, bool threaded)
+{
+	_IS_INIT;
+	_IS_CELL(c);
+
+	c->threaded = threaded;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 void
 dg_core_cell_toggle(dg_core_cell_t *c)
 {
@@ -2269,6 +2883,17 @@ dg_core_cell_toggle(dg_core_cell_t *c)
 	}
 }
 
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_core_cell_unlock(dg_core_cell_t *c)
+{
+	_IS_INIT;
+	_IS_CELL(c);
+
+	_cell_unlock(c);
+}
+
 /************************************************************************************************************/
 /* PUBLIC - CLIPBOARD ***************************************************************************************/
 /************************************************************************************************************/
@@ -2374,7 +2999,9 @@ dg_core_clipboard_paste(int clipboard)
 			free(x_ev);
 			break;
 		} else {
-			dg_core_stack_push(&_events, x_ev, NULL);
+			if (!dg_core_queue_push(&_events, x_ev)) {
+				free(x_ev);
+			}
 		}
 	}
 
@@ -2545,240 +3172,582 @@ dg_core_popup_kill_all(void)
 }
 
 /************************************************************************************************************/
-/* _ ********************************************************************************************************/
+/* PUBLIC - TIMER *******************************************************************************************/
 /************************************************************************************************************/
 
-static _rect_t
-_area_get_current_geometry(_area_t *a, dg_core_window_t *w)
+dg_core_timer_t *
+dg_core_timer_create(void (*fn)(dg_core_timer_t *t), void *props)
 {
-	int16_t l;
-	int16_t n;
-	double  f;
-
-	dg_core_grid_t *g = w->g_current;
-	_rect_t rect = {.x = a->px, .y = a->py, .w = a->pw, .h = a->ph};
-
-	/* extra horizontal offset and width */
+	_IS_INIT;
+	assert(fn);
 
-	f = g->n_fwu;
-	n = w->pw - g->pw;
+	/* the timerfd is only set up when it's needed for the first time */
 
-	for (size_t i = 0; i < a->cx + a->cw; i++) {
-		if (f <= 0.0) {
-			break;
+	if (_timers_fd < 0) {
+		_timers_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+		if (_timers_fd < 0) {
+			dg_core_errno_set(DG_CORE_ERRNO_DEPENDENCY);
+			return NULL;
 		}
-		l  = n * g->fwu[i] / f;
-		f -= g->fwu[i];
-		n -= l;
-		if (i < a->cx) {
-			rect.x += l;
-		} else {
-			rect.w += l;
+		if (!dg_core_loop_add_fd(_timers_fd, POLLIN, _timer_process)) {
+			goto fail_fd;
 		}
 	}
 
-	/* extra vertical offset and height */
+	/* alloc */
 
-	f = g->n_fhu;
-	n = w->ph - g->ph;
+	dg_core_timer_t *t = malloc(sizeof(dg_core_timer_t));
+	if (!t) {
+		dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+		return NULL;
+	}
 
-	for (size_t i = 0; i < a->cy + a->ch; i++) {
-		if (f <= 0.0) {
-			break;
-		}
-		l  = n * g->fhu[i] / f;
-		f -= g->fhu[i];
-		n -= l;
-		if (i < a->cy) {
-			rect.y += l;
-		} else {
-			rect.h += l;
-		}
+	/* set values */
+
+	t->heap_id  = SIZE_MAX;
+	t->deadline = 0;
+	t->period   = 0;
+	t->props    = props;
+	t->fn       = fn;
+
+	/* track */
+
+	if (!dg_core_stack_push(&_timers, t, &t->id)) {
+		free(t);
+		return NULL;
 	}
 
-	return rect;
+	return t;
+
+	/* errors */
+
+fail_fd:
+
+	close(_timers_fd);
+	_timers_fd = -1;
+
+	return NULL;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static dg_core_cell_focus_t
-_area_get_focus_type(_area_t *a, dg_core_window_t *w)
+void
+dg_core_timer_destroy(dg_core_timer_t *t)
 {
-	if (a == w->a_focus && (w->state & DG_CORE_WINDOW_STATE_LOCKED_FOCUS)) {
-		return DG_CORE_CELL_FOCUS_PRIMARY_LOCKED;
-	}
+	_IS_INIT;
+	_IS_TIMER(t);
 
-	if (a == w->a_focus) {
-		return DG_CORE_CELL_FOCUS_PRIMARY;
-	}
+	dg_core_timer_stop(t);
+	dg_core_stack_pull(&_timers, t);
+	free(t);
+}
 
-	if (a->touches.n > 0) {
-		return DG_CORE_CELL_FOCUS_SECONDARY;
-	}
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-	return DG_CORE_CELL_FOCUS_NONE;
+const void *
+dg_core_timer_get_props(dg_core_timer_t *t)
+{
+	_IS_INIT;
+	_IS_TIMER(t);
+
+	return t->props;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static void
-_area_redraw(_area_t *a, dg_core_window_t *w, unsigned long delay)
+bool
+dg_core_timer_is_running(dg_core_timer_t *t)
 {
-	if (!a->redraw && w->render_level != _WINDOW_RENDER_FULL) {
-		return;
-	}
-
-	const dg_core_cell_focus_t focus = _area_get_focus_type(a, w);
+	_IS_INIT;
+	_IS_TIMER(t);
 
-	/* setup drawing context then draw */
+	return t->heap_id != SIZE_MAX;
+}
 
-	_rect_t rect = _area_get_current_geometry(a, w);
-	if (rect.w <= 0 || rect.h <= 0) {
-		return;
-	}
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-	dg_core_cell_drawing_context_t dc = {
-		.msg = DG_CORE_CELL_DRAW_MSG_NONE,
-		.focus = focus,
-		.delay = delay,
-		.cell_px = rect.x,
-		.cell_py = rect.y,
-		.cell_pw = rect.w,
-		.cell_ph = rect.h,
-		.is_enabled = a->c->ena,
-		.win_is_enabled = !(w->state & DG_CORE_WINDOW_STATE_DISABLED),
-		.c_ctx = w->c_ctx,
-	};
+bool
+dg_core_timer_start(dg_core_timer_t *t, unsigned long delay, unsigned long period)
+{
+	_IS_INIT;
+	_IS_TIMER(t);
 
-	cairo_set_operator(w->c_ctx, CAIRO_OPERATOR_SOURCE);
-	a->c->fn_draw(a->c, &dc);
-	a->redraw = (dc.msg & DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE);
+	dg_core_timer_stop(t);
 
-	/* trigger a redraw of neighbouring areas if their focus level is higher */
+	t->deadline = dg_core_util_get_time() + delay;
+	t->period   = period;
 
-	if (!(dc.msg & DG_CORE_CELL_DRAW_MSG_OUT_OF_BOUNDS) || a ==  w->a_focus) {
-		return;
+	if (!_timer_heap_push(t)) {
+		return false;
 	}
 
-	_area_list_t neighbours = _grid_get_neighbour_areas(w->g_current, a);
-	dg_core_cell_focus_t focus_nb;
-
-	for (size_t i = 0; i < neighbours.n; i++) {
-		focus_nb = _area_get_focus_type(neighbours.areas[i], w);
-		if ((focus == DG_CORE_CELL_FOCUS_NONE      && focus_nb != DG_CORE_CELL_FOCUS_NONE) ||
-		    (focus == DG_CORE_CELL_FOCUS_SECONDARY && w->a_focus == neighbours.areas[i])) {
-			neighbours.areas[i]->redraw = true;
-		}
+	if (t->heap_id == 0) {
+		_timer_arm();
 	}
 
-	free(neighbours.areas);
+	return true;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static void
-_area_update_geometry(_area_t *a, dg_core_grid_t *g, bool is_popup)
+void
+dg_core_timer_stop(dg_core_timer_t *t)
 {
-	const int16_t l1 = is_popup ? 0 : DG_CORE_CONFIG->win_pad_outer + DG_CORE_CONFIG->win_thick_bd;
-	const int16_t l2 = is_popup ? 0 : DG_CORE_CONFIG->win_pad_inner;
+	_IS_INIT;
+	_IS_TIMER(t);
 
-	a->px = l1;
-	for (size_t i = 0; i < a->cx; i++) {
-		if (g->cwu[i] != 0) {
-			a->px += l2 + dg_core_config_get_cell_width(g->cwu[i]);
-		}
+	if (t->heap_id == SIZE_MAX) {
+		return;
 	}
 
-	a->py = l1;
-	for (size_t i = 0; i < a->cy; i++) {
-		if (g->chu[i] != 0) {
-			a->py += l2 + dg_core_config_get_cell_height(g->chu[i]);
-		}
-	}
+	const bool was_first = t->heap_id == 0;
 
-	a->pw = dg_core_config_get_cell_width(g->cwu[a->cx]);
-	for (size_t i = a->cx + 1; i < a->cx + a->cw; i++) {
-		if (g->cwu[i] != 0) {
-			a->pw += l2 + dg_core_config_get_cell_width(g->cwu[i]);
-		}
-	}
+	_timer_heap_pull(t);
 
-	a->ph = dg_core_config_get_cell_height(g->chu[a->cy]);
-	for (size_t i = a->cy + 1; i < a->cy + a->ch; i++) {
-		if (g->chu[i] != 0) {
-			a->ph += l2 + dg_core_config_get_cell_height(g->chu[i]);
-		}
+	if (was_first) {
+		_timer_arm();
 	}
-
-	a->pw -= g->cwu[a->cx] != 0 ? 0 : l2;
-	a->ph -= g->chu[a->cy] != 0 ? 0 : l2;
-	a->pw = a->pw > 0 ? a->pw : -l2;
-	a->ph = a->ph > 0 ? a->ph : -l2;
 }
 
-/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+/************************************************************************************************************/
+/* _ ********************************************************************************************************/
+/************************************************************************************************************/
 
 static void
-_cell_destroy(dg_core_cell_t *c)
+_area_clear_redraw(_area_t *a)
 {
-	if (!c->to_destroy) {
-		return;
-	}
+	dg_core_grid_t *g = a->g_parent;
 
-	_RUN_FN(c->fn_destroy, c);
+	if (a->redraw) {
+		g->dirty[a->dirty_id] = g->dirty[--g->n_dirty];
+		g->dirty[a->dirty_id]->dirty_id = a->dirty_id;
+		a->dirty_id = SIZE_MAX;
+	}
 
-	dg_core_stack_pull(&_cells, c);
-	free(c);
+	a->redraw = false;
+	a->clip   = (_rect_t){0, 0, 0, 0};
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 static bool
-_cell_process_bare_event(dg_core_cell_t *c, dg_core_cell_event_t *cev)
+_area_draw_retained(_area_t *a, dg_core_window_t *w, dg_core_cell_drawing_context_t *dc)
 {
-	if (!c || !c->fn_event) {
+	if (!a->c->retained || DG_CORE_CONFIG->retain_budget == 0) {
 		return false;
 	}
 
-	/* fill remaining event fields */
+	_retained_t *r = _retain_find(a->c, dc);
+	if (r && (!r->c_srf || r->filling)) {
+		return false;
+	}
 
-	cev->msg = DG_CORE_CELL_EVENT_MSG_NONE;
-	cev->w_host  = NULL;
-	cev->cell_px = -1;
-	cev->cell_py = -1;
-	cev->cell_pw = -1;
-	cev->cell_ph = -1;
+	/* render the cell offscreen first if its current state has no rendering yet */
 
-	/* send event */
+	dg_core_cell_drawing_context_t dc_tmp = *dc;
+	cairo_t *c_ctx;
 
-	c->fn_event(c, cev);
+	if (!r) {
+		r = _retain_create(a->c, dc, w->c_srf);
+		if (!r) {
+			return false;
+		}
+		c_ctx = cairo_create(r->c_srf);
+		cairo_set_operator(c_ctx, CAIRO_OPERATOR_SOURCE);
+		dc_tmp.cell_px = 0;
+		dc_tmp.cell_py = 0;
+		dc_tmp.c_ctx   = c_ctx;
+		_cell_draw(a->c, &dc_tmp);
+		cairo_destroy(c_ctx);
+		dc_tmp.cell_px = dc->cell_px;
+		dc_tmp.cell_py = dc->cell_py;
+		dc_tmp.c_ctx   = dc->c_ctx;
+		*dc = dc_tmp;
+	}
 
-	/* process msg */
+	/* blit */
 
-	if (cev->msg & DG_CORE_CELL_EVENT_MSG_REJECT) {
-		return false;
-	}
+	cairo_set_source_surface(w->c_ctx, r->c_srf, dc->cell_px, dc->cell_py);
+	cairo_rectangle(w->c_ctx, dc->cell_px, dc->cell_py, dc->cell_pw, dc->cell_ph);
+	cairo_fill(w->c_ctx);
 
-	if (cev->msg & DG_CORE_CELL_EVENT_MSG_REQUEST_UPDATE) {
-		dg_core_cell_redraw(c);
+	/* cells that animate or draw outside of their bounds can't be retained in that state, the latter are */
+	/* drawn again directly on the window since the offscreen surface cut whatever was out of bounds       */
+
+	if (dc->msg != DG_CORE_CELL_DRAW_MSG_NONE) {
+		_retains_size -= (size_t)r->pw * r->ph * 4;
+		cairo_surface_destroy(r->c_srf);
+		r->c_srf = NULL;
+		return !(dc->msg & DG_CORE_CELL_DRAW_MSG_OUT_OF_BOUNDS);
 	}
 
+	_retain_use(r);
+	_retain_trim();
+
 	return true;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static void
-_clipboard_clear(int clipboard)
+static _rect_t
+_area_get_current_geometry(_area_t *a, dg_core_window_t *w)
 {
-	free(_sel[clipboard].data);
+	dg_core_grid_t *g = w->g_current;
 
-	_sel[clipboard].time     = 0;
-	_sel[clipboard].owned    = false;
-	_sel[clipboard].data     = NULL;
-	_sel[clipboard].data_n   = 0;
-	_sel[clipboard].fn_copy  = NULL;
-	_sel[clipboard].fn_lost  = NULL;
+	_grid_update_growth(g, w->pw - g->pw, w->ph - g->ph);
+
+	/* add the extra space the columns and rows before and within the area have gained */
+
+	return (_rect_t){
+		.x = a->px + g->fxo[a->cx],
+		.y = a->py + g->fyo[a->cy],
+		.w = a->pw + g->fxo[a->cx + a->cw] - g->fxo[a->cx],
+		.h = a->ph + g->fyo[a->cy + a->ch] - g->fyo[a->cy],
+	};
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static dg_core_cell_focus_t
+_area_get_focus_type(_area_t *a, dg_core_window_t *w)
+{
+	if (a == w->a_focus && (w->state & DG_CORE_WINDOW_STATE_LOCKED_FOCUS)) {
+		return DG_CORE_CELL_FOCUS_PRIMARY_LOCKED;
+	}
+
+	if (a == w->a_focus) {
+		return DG_CORE_CELL_FOCUS_PRIMARY;
+	}
+
+	if (a->touches.n > 0) {
+		return DG_CORE_CELL_FOCUS_SECONDARY;
+	}
+
+	return DG_CORE_CELL_FOCUS_NONE;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_area_redraw(_area_t *a, dg_core_window_t *w, unsigned long delay)
+{
+	_area_job_t job;
+
+	if (_area_redraw_prepare(a, w, delay, &job)) {
+		_area_redraw_draw(a, w, &job);
+		_area_redraw_finish(a, w, &job);
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_area_redraw_draw(_area_t *a, dg_core_window_t *w, _area_job_t *job)
+{
+	/* deferred drawing operations have to be carried out before the core touches the context on its own, */
+	/* like when clipping it or blitting retained renderings                                              */
+
+	const bool retained = !job->clip && a->c->retained && DG_CORE_CONFIG->retain_budget > 0;
+
+	job->dc.c_ctx = w->c_ctx;
+
+	if (job->clip || retained) {
+		_window_batch_draws(w, false);
+	}
+
+	if (job->clip) {
+		cairo_save(w->c_ctx);
+		cairo_rectangle(w->c_ctx, job->rect_clip.x, job->rect_clip.y, job->rect_clip.w, job->rect_clip.h);
+		cairo_clip(w->c_ctx);
+		_window_batch_draws(w, true);
+	}
+
+	cairo_set_operator(w->c_ctx, CAIRO_OPERATOR_SOURCE);
+	if (!retained || !_area_draw_retained(a, w, &job->dc)) {
+		_cell_draw(a->c, &job->dc);
+	}
+	if (job->clip) {
+		_window_batch_draws(w, false);
+		cairo_restore(w->c_ctx);
+	}
+
+	if (job->clip || retained) {
+		_window_batch_draws(w, true);
+	}
+
+	job->done = true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_area_redraw_finish(_area_t *a, dg_core_window_t *w, const _area_job_t *job)
+{
+	const dg_core_cell_drawing_context_t *dc = &job->dc;
+
+	if (dc->msg & DG_CORE_CELL_DRAW_MSG_OUT_OF_BOUNDS && !job->clip) {
+		_window_add_damage(w, (_rect_t){0, 0, w->pw, w->ph});
+	} else {
+		_window_add_damage(w, job->rect_clip);
+	}
+
+	/* schedule the next update */
+
+	if (a->wake_w) {
+		_window_wake_pull(a->wake_w, a);
+	}
+
+	if (dc->msg & DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE) {
+		_area_request_redraw(a, NULL);
+	} else if (dc->msg & DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE_REGION && dc->update_pw > 0 && dc->update_ph > 0) {
+		_area_request_redraw(a, &(_rect_t){dc->update_px, dc->update_py, dc->update_pw, dc->update_ph});
+	} else if (dc->msg & DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE_AT) {
+		a->wake      = dc->update_time;
+		a->wake_clip = dc->update_pw > 0 && dc->update_ph > 0 ?
+			(_rect_t){dc->update_px, dc->update_py, dc->update_pw, dc->update_ph} :
+			(_rect_t){0, 0, 0, 0};
+		if (_window_wake_push(w, a)) {
+			_window_wake_arm(w);
+		}
+	}
+
+	/* trigger a redraw of neighbouring areas if their focus level is higher */
+
+	if (!(dc->msg & DG_CORE_CELL_DRAW_MSG_OUT_OF_BOUNDS) || a ==  w->a_focus) {
+		return;
+	}
+
+	_area_list_t neighbours = _grid_get_neighbour_areas(w->g_current, a);
+	dg_core_cell_focus_t focus_nb;
+
+	for (size_t i = 0; i < neighbours.n; i++) {
+		focus_nb = _area_get_focus_type(neighbours.areas[i], w);
+		if ((dc->focus == DG_CORE_CELL_FOCUS_NONE      && focus_nb != DG_CORE_CELL_FOCUS_NONE) ||
+		    (dc->focus == DG_CORE_CELL_FOCUS_SECONDARY && w->a_focus == neighbours.areas[i])) {
+			_area_request_redraw(neighbours.areas[i], NULL);
+		}
+	}
+
+	free(neighbours.areas);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_area_redraw_prepare(_area_t *a, dg_core_window_t *w, unsigned long delay, _area_job_t *job)
+{
+	if (!a->redraw && w->render_level != _WINDOW_RENDER_FULL) {
+		return false;
+	}
+
+	/* setup drawing context */
+
+	_rect_t rect = _area_get_current_geometry(a, w);
+	if (rect.w <= 0 || rect.h <= 0) {
+		return false;
+	}
+
+	/* restrict the drawing to the requested part of the area, unless everything is being repainted */
+
+	_rect_t rect_clip = rect;
+
+	const bool clip = a->redraw && a->clip.w > 0 && w->render_level != _WINDOW_RENDER_FULL;
+	if (clip) {
+		const int16_t x1 = a->clip.x > 0 ? a->clip.x : 0;
+		const int16_t y1 = a->clip.y > 0 ? a->clip.y : 0;
+		const int16_t x2 = a->clip.x + a->clip.w < rect.w ? a->clip.x + a->clip.w : rect.w;
+		const int16_t y2 = a->clip.y + a->clip.h < rect.h ? a->clip.y + a->clip.h : rect.h;
+		rect_clip = (_rect_t){rect.x + x1, rect.y + y1, x2 - x1, y2 - y1};
+		if (rect_clip.w <= 0 || rect_clip.h <= 0) {
+			_area_clear_redraw(a);
+			return false;
+		}
+	}
+
+	/* the request is consumed here, so that new ones made while the area is being drawn are kept */
+
+	_area_clear_redraw(a);
+
+	job->a           = a;
+	job->rect_clip   = rect_clip;
+	job->clip        = clip;
+	job->done        = false;
+	job->c_retained  = NULL;
+	job->retain_fill = false;
+	job->dc        = (dg_core_cell_drawing_context_t){
+		.msg = DG_CORE_CELL_DRAW_MSG_NONE,
+		.focus = _area_get_focus_type(a, w),
+		.delay = delay,
+		.cell_px = rect.x,
+		.cell_py = rect.y,
+		.cell_pw = rect.w,
+		.cell_ph = rect.h,
+		.is_enabled = a->c->ena,
+		.win_is_enabled = !(w->state & DG_CORE_WINDOW_STATE_DISABLED),
+		.c_ctx = w->c_ctx,
+		.update_px = 0,
+		.update_py = 0,
+		.update_pw = 0,
+		.update_ph = 0,
+		.update_time = 0,
+	};
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_area_request_redraw(_area_t *a, const _rect_t *region)
+{
+	int16_t x2, y2;
+
+	/* whole area requests override partial ones, which get merged into their bounding box */
+
+	if (!region) {
+		a->clip = (_rect_t){0, 0, 0, 0};
+	} else if (!a->redraw) {
+		a->clip = *region;
+	} else if (a->clip.w > 0) {
+		x2 = a->clip.x + a->clip.w > region->x + region->w ? a->clip.x + a->clip.w : region->x + region->w;
+		y2 = a->clip.y + a->clip.h > region->y + region->h ? a->clip.y + a->clip.h : region->y + region->h;
+		a->clip.x = a->clip.x < region->x ? a->clip.x : region->x;
+		a->clip.y = a->clip.y < region->y ? a->clip.y : region->y;
+		a->clip.w = x2 - a->clip.x;
+		a->clip.h = y2 - a->clip.y;
+	}
+
+	if (!a->redraw) {
+		a->dirty_id = a->g_parent->n_dirty;
+		a->g_parent->dirty[a->g_parent->n_dirty++] = a;
+	}
+
+	a->redraw = true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_area_update_geometry(_area_t *a, dg_core_grid_t *g, bool is_popup)
+{
+	const int16_t l1 = is_popup ? 0 : DG_CORE_CONFIG->win_pad_outer + DG_CORE_CONFIG->win_thick_bd;
+	const int16_t l2 = is_popup ? 0 : DG_CORE_CONFIG->win_pad_inner;
+
+	/* the grid's offsets include the padding after each column and row, which is not part of the area */
+
+	a->px = l1 + g->pxo[a->cx];
+	a->py = l1 + g->pyo[a->cy];
+	a->pw = g->pxo[a->cx + a->cw] - g->pxo[a->cx] - l2;
+	a->ph = g->pyo[a->cy + a->ch] - g->pyo[a->cy] - l2;
+	a->pw = a->pw > 0 ? a->pw : -l2;
+	a->ph = a->ph > 0 ? a->ph : -l2;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_cell_destroy(dg_core_cell_t *c)
+{
+	if (!c->to_destroy) {
+		return;
+	}
+
+	_render_wait();
+
+	_RUN_FN(c->fn_destroy, c);
+
+	for (size_t i = 0; i < c->areas.n; i++) {
+		((_area_t*)c->areas.ptr[i])->id_cell.i = SIZE_MAX;
+	}
+
+	_retain_clear(c);
+
+	dg_core_slotmap_reset(&c->areas);
+	dg_core_slotmap_pull(&_cells, c->id);
+	dg_core_stack_pull(&_cells_trash, c);
+	pthread_mutex_destroy(&c->mutex);
+	free(c);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_cell_draw(dg_core_cell_t *c, dg_core_cell_drawing_context_t *dc)
+{
+	pthread_mutex_lock(&c->mutex);
+	c->fn_draw(c, dc);
+	_cell_unlock(c);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_cell_process_bare_event(dg_core_cell_t *c, dg_core_cell_event_t *cev)
+{
+	if (!c || !c->fn_event) {
+		return false;
+	}
+
+	/* fill remaining event fields */
+
+	cev->msg = DG_CORE_CELL_EVENT_MSG_NONE;
+	cev->w_host  = NULL;
+	cev->cell_px = -1;
+	cev->cell_py = -1;
+	cev->cell_pw = -1;
+	cev->cell_ph = -1;
+
+	/* send event */
+
+	pthread_mutex_lock(&c->mutex);
+	c->fn_event(c, cev);
+	_cell_unlock(c);
+
+	/* process msg */
+
+	if (cev->msg & DG_CORE_CELL_EVENT_MSG_REJECT) {
+		return false;
+	}
+
+	if (cev->msg & DG_CORE_CELL_EVENT_MSG_REQUEST_UPDATE) {
+		dg_core_cell_redraw(c);
+	}
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_cell_unlock(dg_core_cell_t *c)
+{
+	pthread_mutex_unlock(&c->mutex);
+
+	/* wake the render thread up if it is waiting for this cell, the fence pairs with the one in */
+	/* _render_lock_cell() so that either the thread sees the cell unlocked or we see it waiting */
+
+	atomic_thread_fence(memory_order_seq_cst);
+
+	if (atomic_load(&_render_blocked) == c) {
+		pthread_mutex_lock(&_render_mutex);
+		pthread_cond_broadcast(&_render_cond);
+		pthread_mutex_unlock(&_render_mutex);
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_clipboard_clear(int clipboard)
+{
+	free(_sel[clipboard].data);
+
+	_sel[clipboard].time     = 0;
+	_sel[clipboard].owned    = false;
+	_sel[clipboard].data     = NULL;
+	_sel[clipboard].data_n   = 0;
+	_sel[clipboard].fn_copy  = NULL;
+	_sel[clipboard].fn_lost  = NULL;
 	_sel[clipboard].c_signal = NULL;
 }
 
@@ -2895,26 +3864,13 @@ _event_core_input(xcb_key_press_event_t *x_ev)
 	bool is_key   = type == XCB_KEY_PRESS || type == XCB_KEY_RELEASE;
 	bool is_press = type == XCB_KEY_PRESS || type == XCB_BUTTON_PRESS;
 
-	/* get swap shift level */
-
-	int shift;
-
-	if (!(x_ev->state & DG_CORE_CONFIG->mod_meta)) {
-		shift = 0;
-	} else if (x_ev->state & XCB_MOD_MASK_SHIFT) {
-		shift = 2;
-	} else {
-		shift = 1;
-	}
-
 	/* get swap */
 
-	if ((is_key && val > DG_CORE_CONFIG_MAX_KEYS) || (!is_key && val > DG_CORE_CONFIG_MAX_BUTTONS)) {
+	dg_core_config_swap_t swap;
+
+	if (!_misc_get_input_swap(x_ev, &swap)) {
 		return;
 	}
-	
-	dg_core_config_swap_t swap = is_key ? DG_CORE_CONFIG->swap_key[val][shift] : 
-	                                      DG_CORE_CONFIG->swap_but[val][shift];
 
 	/* do stuff depending on swap type whether the button/key are pressed or released */
 
@@ -2988,6 +3944,20 @@ _event_expose(xcb_expose_event_t *x_ev)
 		return;
 	}
 
+	/* serve the exposed region straight from the last presented frame, only repaint if there is none */
+
+	if (w->i_front != SIZE_MAX) {
+		xcb_copy_area(
+			_x_con,
+			w->bufs[w->i_front].x_pix,
+			w->x_win,
+			w->x_gc,
+			x_ev->x, x_ev->y,
+			x_ev->x, x_ev->y,
+			x_ev->width, x_ev->height);
+		return;
+	}
+
 	_window_set_render_level(w, _WINDOW_RENDER_FULL);
 	_window_set_present_schedule(w, _WINDOW_PRESENT_IMMEDIATE);
 }
@@ -3115,8 +4085,22 @@ static void
 _event_present(xcb_present_generic_event_t *x_ev)
 {
 	xcb_present_complete_notify_event_t *x_pev;
+	xcb_present_idle_notify_event_t *x_iev;
 	dg_core_window_t *w;
 
+	/* give back pixmaps the X server is done with to their window's swapchain */
+
+	if (x_ev->evtype == XCB_PRESENT_EVENT_IDLE_NOTIFY) {
+		x_iev = (xcb_present_idle_notify_event_t *)x_ev;
+		w = _loop_find_window(x_iev->window);
+		for (size_t i = 0; w && i < _WINDOW_BUFFERS; i++) {
+			if (w->bufs[i].x_pix == x_iev->pixmap) {
+				w->bufs[i].idle = true;
+			}
+		}
+		return;
+	}
+
 	/* present event filtering */
 
 	if (x_ev->evtype != XCB_PRESENT_EVENT_COMPLETE_NOTIFY) {
@@ -3124,19 +4108,30 @@ _event_present(xcb_present_generic_event_t *x_ev)
 	}
 
 	x_pev = (xcb_present_complete_notify_event_t *)x_ev;
-	if (x_pev->kind != XCB_PRESENT_COMPLETE_KIND_NOTIFY_MSC) {
+	w = _loop_find_window(x_pev->window);
+	if (!w) {
 		return;
 	}
 
-	w = _loop_find_window(x_pev->window);
-	if (!w || w->present_serial != x_pev->serial) {
+	/* presented frames tell whether the window keeps up with its framerate */
+
+	if (x_pev->kind == XCB_PRESENT_COMPLETE_KIND_PIXMAP) {
+		_window_pace_account(w, x_pev->serial, x_pev->msc);
+		return;
+	}
+
+	if (x_pev->kind != XCB_PRESENT_COMPLETE_KIND_NOTIFY_MSC) {
+		return;
+	}
+
+	if (w->present_serial != x_pev->serial) {
 		return;
 	}
 
 	/* update window's content */
 
 	if (w->g_current) {
-		_window_redraw(w);
+		_window_pace(w, x_pev->msc, x_pev->ust);
 	}
 }
 
@@ -3235,6 +4230,28 @@ refuse:
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static void
+_event_shm(xcb_shm_completion_event_t *x_ev)
+{
+	dg_core_window_t *w;
+
+	/* the server is done reading the segment, redraws that were held back can go on */
+
+	for (size_t i = 0; i < _windows.n; i++) {
+		w = (dg_core_window_t*)_windows.ptr[i];
+		if (w->img.x_seg != x_ev->shmseg || w->img.n_pushes == 0) {
+			continue;
+		}
+		if (--w->img.n_pushes == 0 && w->img.pending) {
+			w->img.pending = false;
+			_window_redraw(w);
+		}
+		return;
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static void
 _event_unmap(xcb_unmap_notify_event_t *x_ev)
 {
@@ -3308,21 +4325,35 @@ _grid_destroy(dg_core_grid_t *g)
 		return;
 	}
 
+	_render_wait();
+
 	_area_t *a;
 
 	for (size_t i = 0; i < g->areas.n; i++) {
 		a = (_area_t*)g->areas.ptr[i];
+		if (a->id_cell.i != SIZE_MAX) {
+			dg_core_slotmap_pull(&a->c->areas, a->id_cell);
+		}
+		if (a->wake_w) {
+			_window_wake_pull(a->wake_w, a);
+		}
 		dg_core_input_buffer_reset(&a->touches);
 		free(a);
 	}
 
-	dg_core_stack_reset(&g->areas);
+	dg_core_slotmap_reset(&g->areas);
+	free(g->dirty);
 	free(g->chu);
 	free(g->cwu);
 	free(g->fwu);
 	free(g->fhu);
+	free(g->pxo);
+	free(g->pyo);
+	free(g->fxo);
+	free(g->fyo);
 	
-	dg_core_stack_pull(&_grids, g);
+	dg_core_slotmap_pull(&_grids, g->id);
+	dg_core_stack_pull(&_grids_trash, g);
 	free(g);
 }
 
@@ -3338,18 +4369,30 @@ _grid_find_first_area(dg_core_grid_t *g, dg_core_cell_t *c)
 		.seek_cell = c,
 	};
 
-	/* first check if an area holds the target cell, if not, send a cell seek event to that area's cell */
-	/* if the event has not been rejected, then it should mean that the target cell is somewhere        */
-	/* within that area's cell (and that cell is therefore a meta-cell).                                */
+	/* look up the first area of the grid that directly holds the target cell through the cell's own list */
 
-	for (size_t i = 0; i < g->areas.n; i++) {
+	size_t i_match = g->areas.n;
+	size_t i;
+
+	for (size_t j = 0; j < c->areas.n; j++) {
+		a = (_area_t*)c->areas.ptr[j];
+		if (a->g_parent == g && (i = dg_core_slotmap_locate(&g->areas, a->id)) < i_match) {
+			i_match = i;
+		}
+	}
+
+	/* areas before it may still hold the target cell indirectly, so send a cell seek event to their cell */
+	/* if the event has not been rejected, then it should mean that the target cell is somewhere within   */
+	/* that area's cell (and that cell is therefore a meta-cell).                                         */
+
+	for (i = 0; i < i_match; i++) {
 		a = (_area_t*)g->areas.ptr[i];
-		if (c == a->c || _cell_process_bare_event(a->c, &cev)) {
+		if (_cell_process_bare_event(a->c, &cev)) {
 			return a;
 		}
 	}
 
-	return NULL;
+	return i_match < g->areas.n ? (_area_t*)g->areas.ptr[i_match] : NULL;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -3401,195 +4444,886 @@ _grid_update_geometry(dg_core_grid_t *g, bool is_popup)
 	const int16_t l1 = is_popup ? 0 : 2 * (DG_CORE_CONFIG->win_thick_bd + DG_CORE_CONFIG->win_pad_outer);
 	const int16_t l2 = is_popup ? 0 : DG_CORE_CONFIG->win_pad_inner;
 
-	g->pw = l1 + dg_core_config_get_cell_width(g->cwu[0]);
-	for (size_t i = 1; i < g->cw; i++) {
-		if (g->cwu[i] != 0) {
-			g->pw += l2 + dg_core_config_get_cell_width(g->cwu[i]);
-		}
+	/* prefix sums of the column and row sizes, so that areas and hit tests get their geometry in O(1) */
+	/* hidden columns and rows take no space, not even padding                                        */
+
+	g->pxo[0] = 0;
+	for (size_t i = 0; i < g->cw; i++) {
+		g->pxo[i + 1] = g->pxo[i] + (g->cwu[i] != 0 ? l2 + dg_core_config_get_cell_width(g->cwu[i]) : 0);
 	}
 
-	g->ph = l1 + dg_core_config_get_cell_height(g->chu[0]);
-	for (size_t i = 1; i < g->ch; i++) {
-		if (g->chu[i] != 0) {
-			g->ph += l2 + dg_core_config_get_cell_height(g->chu[i]);
-		}
+	g->pyo[0] = 0;
+	for (size_t i = 0; i < g->ch; i++) {
+		g->pyo[i + 1] = g->pyo[i] + (g->chu[i] != 0 ? l2 + dg_core_config_get_cell_height(g->chu[i]) : 0);
 	}
 
-	g->pw -= g->cwu[0] != 0 ? 0 : l2;
-	g->ph -= g->chu[0] != 0 ? 0 : l2;
+	g->pw = l1 + g->pxo[g->cw] - l2;
+	g->ph = l1 + g->pyo[g->ch] - l2;
+
+	/* the minimum size may have changed, so the extra space has to be spread again */
+
+	g->fxo_n = INT16_MIN;
+	g->fyo_n = INT16_MIN;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static dg_core_window_t *
-_loop_find_window(xcb_window_t x_win)
+static void
+_grid_update_growth(dg_core_grid_t *g, int16_t nw, int16_t nh)
 {
-	dg_core_window_t *win;
+	int16_t l;
+	int16_t n;
+	double  f;
 
-	for (size_t i = 0; i < _windows.n; i++) {
-		win = (dg_core_window_t*)_windows.ptr[i];
-		if (x_win == win->x_win) {
-			return win;
+	/* spread extra pixels across columns and rows by growth factor, each one takes its share of what */
+	/* the previous ones left so that rounding errors do not add up. Done only when the amount changes */
+
+	if (g->fxo_n != nw) {
+		f = g->n_fwu;
+		n = nw;
+		g->fxo[0] = 0;
+		for (size_t i = 0; i < g->cw; i++) {
+			l  = f > 0.0 ? n * g->fwu[i] / f : 0;
+			f -= g->fwu[i];
+			n -= l;
+			g->fxo[i + 1] = g->fxo[i] + l;
+		}
+		g->fxo_n = nw;
+	}
+
+	if (g->fyo_n != nh) {
+		f = g->n_fhu;
+		n = nh;
+		g->fyo[0] = 0;
+		for (size_t i = 0; i < g->ch; i++) {
+			l  = f > 0.0 ? n * g->fhu[i] / f : 0;
+			f -= g->fhu[i];
+			n -= l;
+			g->fyo[i + 1] = g->fyo[i] + l;
 		}
+		g->fyo_n = nh;
 	}
-
-	return NULL;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static bool
-_loop_no_active_windows(void)
+static void
+_loop_coalesce_events(void)
 {
-	for (size_t i = 0; i < _windows.n; i++) {
-		if (((dg_core_window_t *)_windows.ptr[i])->state & DG_CORE_WINDOW_STATE_ACTIVE) {
-			return false;
+	xcb_generic_event_t *x_ev;
+	xcb_generic_event_t *x_ev_next;
+	xcb_key_press_event_t *x_kev;
+	xcb_key_press_event_t *x_kev_next;
+	xcb_motion_notify_event_t *x_mev;
+	xcb_motion_notify_event_t *x_mev_next;
+	dg_core_config_swap_t swap;
+
+	xcb_keycode_t rep_key = 0; /* key of the last kept focus action press, 0 if none */
+	xcb_window_t  rep_win = 0; /* window of said press                               */
+
+	/* go through the queue once, kept events are pushed back at its end so the order is preserved */
+
+	const size_t n = _events.n;
+
+	for (size_t i = 0; i < n; i++) {
+
+		x_ev      = (xcb_generic_event_t*)dg_core_queue_pop(&_events);
+		x_ev_next = i + 1 < n ? (xcb_generic_event_t*)dg_core_queue_peek(&_events) : NULL;
+
+		switch (x_ev->response_type & ~0x80) {
+
+			/* only the latest motion matters if the next event is another motion over the same window */
+
+			case XCB_MOTION_NOTIFY:
+				if (!x_ev_next || (x_ev_next->response_type & ~0x80) != XCB_MOTION_NOTIFY) {
+					break;
+				}
+				x_mev      = (xcb_motion_notify_event_t*)x_ev;
+				x_mev_next = (xcb_motion_notify_event_t*)x_ev_next;
+				if (x_mev->event == x_mev_next->event && x_mev->state == x_mev_next->state) {
+					goto drop;
+				}
+				break;
+
+			/* repeated presses of a key bound to a focus action are only run once per batch */
+
+			case XCB_KEY_PRESS:
+				x_kev = (xcb_key_press_event_t*)x_ev;
+				if (!_misc_get_input_swap(x_kev, &swap) || swap.kind != DG_CORE_CONFIG_SWAP_TO_ACTION_FOCUS) {
+					rep_key = 0;
+					break;
+				}
+				if (x_kev->detail == rep_key && x_kev->event == rep_win) {
+					goto drop;
+				}
+				rep_key = x_kev->detail;
+				rep_win = x_kev->event;
+				break;
+
+			/* X auto-repeat shows up as a release immediately followed by a press with the same timestamp */
+
+			case XCB_KEY_RELEASE:
+				x_kev = (xcb_key_press_event_t*)x_ev;
+				if (x_kev->detail != rep_key || x_kev->event != rep_win) {
+					rep_key = 0;
+					break;
+				}
+				if (!x_ev_next || (x_ev_next->response_type & ~0x80) != XCB_KEY_PRESS) {
+					rep_key = 0;
+					break;
+				}
+				x_kev_next = (xcb_key_press_event_t*)x_ev_next;
+				if (x_kev_next->detail == x_kev->detail && x_kev_next->time == x_kev->time) {
+					goto drop;
+				}
+				rep_key = 0;
+				break;
+
+			case XCB_BUTTON_PRESS:
+			case XCB_BUTTON_RELEASE:
+				rep_key = 0;
+				break;
+
+			default:
+				break;
 		}
-	}
 
-	return true;
+		dg_core_queue_push(&_events, x_ev); /* cannot fail, the pop above freed a slot */
+		continue;
+
+	drop:
+
+		free(x_ev);
+	}
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 static void
-_misc_reconfig(void)
+_loop_dispatch_event(xcb_generic_event_t *x_ev)
 {
-	dg_core_resource_load_all();
+	/* extra user's pre-event processor */
 
-	dg_core_window_t *w;
-	dg_core_grid_t *g;
-	dg_core_grid_t *g_min;
+	_RUN_INT_FN(_fn_event_preprocessor, goto skip, x_ev);
 
-	/* update all windows                                                */
-	/* resize them if they are smaller than their new minimun dimensions */
+	/* error events */
 
-	for (size_t i = 0; i < _windows.n; i++) {
+	if (x_ev->response_type == 0) {
+		dg_core_errno_set(DG_CORE_ERRNO_XCB);
+		goto skip;
+	}
 
-		w = (dg_core_window_t*)_windows.ptr[i];
-		g = w->g_current;
-		g_min = _window_find_smallest_grid(w);
+	/* built-in event processors, extension events with a code of their own go first */
 
-		if (!(w->state & DG_CORE_WINDOW_STATE_ACTIVE)) {
-			dg_core_window_reset_current_grid(w);
-			continue;
-		}
+	if (_x_evt_shm && (x_ev->response_type & ~0x80) == _x_evt_shm + XCB_SHM_COMPLETION) {
+		_event_shm((xcb_shm_completion_event_t*)x_ev);
+		goto skip;
+	}
 
-		_window_update_geometries(w, w->p_container);
-		_window_update_current_grid(w);
-		_window_update_wm_size_hints(w);
-		_window_set_render_level(w, _WINDOW_RENDER_FULL);
-		_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
+	switch (x_ev->response_type & ~0x80) {
 
-		if (g->n_fwu == 0.0 || (g == g_min && g->pw > w->pw)) {
-			xcb_configure_window(_x_con, w->x_win, XCB_CONFIG_WINDOW_WIDTH, &g->pw);
-		}
+		/* can mix key and button_press events because their structs have the same fields */
 
-		if (g->n_fhu == 0.0 || (g == g_min && g->ph > w->ph)) {
-			xcb_configure_window(_x_con, w->x_win, XCB_CONFIG_WINDOW_HEIGHT, &g->ph);
-		}
+		case XCB_BUTTON_PRESS:
+		case XCB_BUTTON_RELEASE:
+		case XCB_KEY_PRESS:
+		case XCB_KEY_RELEASE:
+			_event_core_input((xcb_key_press_event_t*)x_ev);
+			break;
+
+		case XCB_LEAVE_NOTIFY:
+			_event_leave((xcb_leave_notify_event_t*)x_ev);
+			break;
+
+		case XCB_UNMAP_NOTIFY:
+			_event_unmap((xcb_unmap_notify_event_t*)x_ev);
+			break;
+
+		case XCB_MAP_NOTIFY:
+			_event_map((xcb_map_notify_event_t*)x_ev);
+			break;
+
+		case XCB_EXPOSE:
+			_event_expose((xcb_expose_event_t*)x_ev);
+			break;
+
+		case XCB_MOTION_NOTIFY:
+			_event_motion((xcb_motion_notify_event_t*)x_ev);
+			break;
+
+		case XCB_FOCUS_IN:
+			_event_focus_in((xcb_focus_in_event_t*)x_ev);
+			break;
+
+		case XCB_FOCUS_OUT:
+			_event_focus_out((xcb_focus_in_event_t*)x_ev);
+			break;
+
+		case XCB_CLIENT_MESSAGE:
+			_event_client_message((xcb_client_message_event_t*)x_ev);
+			break;
+
+		case XCB_CONFIGURE_NOTIFY:
+			_event_configure((xcb_configure_notify_event_t*)x_ev);
+			break;
+
+		case XCB_VISIBILITY_NOTIFY:
+			_event_visibility((xcb_visibility_notify_event_t*)x_ev);
+			break;
+
+		case XCB_MAPPING_NOTIFY:
+			_event_keymap((xcb_mapping_notify_event_t*)x_ev);
+			break;
+
+		case XCB_SELECTION_CLEAR:
+			_event_selection_clear((xcb_selection_clear_event_t*)x_ev);
+			break;
+
+		case XCB_SELECTION_REQUEST:
+			_event_selection_request((xcb_selection_request_event_t*)x_ev);
+			break;
+
+		case XCB_GE_GENERIC:
+			if (((xcb_ge_generic_event_t*)x_ev)->extension == _x_opc_present) {
+				_event_present((xcb_present_generic_event_t*)x_ev);
+			} else if (((xcb_ge_generic_event_t*)x_ev)->extension == _x_opc_xinput) {
+				_event_xinput_touch((xcb_input_touch_begin_event_t*)x_ev);
+			}
+			break;
 	}
+
+skip:
+
+	/* extra user's post-event processor */
+
+	_RUN_FN(_fn_event_postprocessor, x_ev);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static _popup_t *
-_popup_find_under_coords(int16_t px, int16_t py)
+static bool
+_loop_fill_events(void)
 {
-	_popup_t *p = _p_last;
+	xcb_generic_event_t *x_ev;
 
-	do {
-		if (dg_core_util_test_bounds(px, py, p->px, p->py, p->pw, p->ph)) {
-			return p;
+	if (_events.n == 0 && !_loop_wait_events()) {
+		return false;
+	}
+
+	while ((x_ev = xcb_poll_for_queued_event(_x_con))) {
+		if (!dg_core_queue_push(&_events, x_ev)) {
+			free(x_ev);
+			break;
 		}
-		p = p->p_parent;
-	} while (p);
+	}
 
-	return NULL;
+	return true;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static _rect_t
-_popup_get_geometry(dg_core_window_t *w_ref, int16_t px, int16_t px_alt, int16_t py_alt, int16_t py, 
-	int16_t pw, int16_t ph)
-{ 
-	if (w_ref) {
-		px += w_ref->px;
-		py += w_ref->py;
-		px_alt += w_ref->px;
-		py_alt += w_ref->py;
-	}
+static int
+_loop_poll_fds(int timeout)
+{
+	_fd_watch_t *fw;
+	int n_ran = 0;
 
-	/* apply overrides and max geometry */
+	/* prepare poll() buffer, the first slot is the X connection */
 
-	if (DG_CORE_CONFIG->popup_override_position) {
-		px = DG_CORE_CONFIG->popup_override_px;
-		py = DG_CORE_CONFIG->popup_override_py;
-		px_alt = DG_CORE_CONFIG->popup_override_px;
-		py_alt = DG_CORE_CONFIG->popup_override_py;
-	}
+	const size_t n = _fds.n + 1;
 
-	if (DG_CORE_CONFIG->popup_override_width && DG_CORE_CONFIG->popup_override_pw > 0) {
-		pw = DG_CORE_CONFIG->popup_override_pw;
-	} else if (DG_CORE_CONFIG->popup_max_pw > 0) {
-		pw = DG_CORE_CONFIG->popup_max_pw;
+	if (n > _fds_poll_n) {
+		struct pollfd *tmp = realloc(_fds_poll, n * sizeof(struct pollfd));
+		if (!tmp) {
+			dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+			return -1;
+		}
+		_fds_poll   = tmp;
+		_fds_poll_n = n;
 	}
 
-	if (DG_CORE_CONFIG->popup_override_height && DG_CORE_CONFIG->popup_override_ph > 0) {
-		pw = DG_CORE_CONFIG->popup_override_ph;
-	} else if (DG_CORE_CONFIG->popup_max_ph > 0) {
-		pw = DG_CORE_CONFIG->popup_max_ph;
+	_fds_poll[0].fd     = xcb_get_file_descriptor(_x_con);
+	_fds_poll[0].events = POLLIN;
+
+	for (size_t i = 1; i < n; i++) {
+		_fds_poll[i].fd     = ((_fd_watch_t*)_fds.ptr[i - 1])->fd;
+		_fds_poll[i].events = ((_fd_watch_t*)_fds.ptr[i - 1])->events;
 	}
 
-	/* find which display will the popup appear on and retrieve its geometry */
-	/* thrn adjust the popup's geometry based on the monitor's geometry      */
+	/* a failure is most likely an interruption by a signal */
 
-	_rect_t rect = _x_get_monitor_geometry_at(px, py);
-	if (rect.w <= 0 || rect.h <= 0) {
-		goto skip_adjust;
+	if (poll(_fds_poll, n, timeout) <= 0) {
+		return 0;
 	}
 
-	if (px + pw > rect.x + rect.w) {
-		px = px_alt - pw;
-	}
+	/* run the callbacks, watches are searched again because a callback can remove or add some */
 
-	if (py + ph > rect.y + rect.h) {
-		py = py_alt - ph;
+	for (size_t i = 1; i < n; i++) {
+		if (_fds_poll[i].revents == 0) {
+			continue;
+		}
+		fw = _loop_find_fd(_fds_poll[i].fd);
+		if (fw) {
+			fw->fn(fw->fd, _fds_poll[i].revents);
+			n_ran++;
+		}
+		if (!_init || !_loop) {
+			break;
+		}
 	}
 
-	if (px < rect.x) {
-		px = rect.x;
-	}
+	return n_ran;
+}
 
-	if (py < rect.y) {
-		py = rect.y;
-	}
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-	if (pw > rect.w) {
-		pw = rect.w;
-	}
+static void
+_loop_process_messages(int fd, short revents)
+{
+	_message_t *msg;
+	uint64_t n_wake;
 
-	if (ph > rect.h) {
-		ph = rect.h;
+	/* reset the eventfd counter before draining so that no wake-up from a later push can be lost */
+
+	if (fd >= 0 && read(fd, &n_wake, sizeof(n_wake)) < 0) {
+		n_wake = 0;
 	}
 
-skip_adjust:
+	/* drain at most a full queue worth of messages, if producers keep pushing, wake up again right after */
 
-	/*****/
+	for (size_t i = 0; _init && i < _MESSAGES_LEN; i++) {
+		msg = &_msgs[_msgs_head % _MESSAGES_LEN];
+		if (atomic_load_explicit(&msg->seq, memory_order_acquire) != _msgs_head + 1) {
+			return;
+		}
+		const bool     is_signal = msg->is_signal;
+		const uint32_t serial    = msg->serial;
+		void          *data      = msg->data;
+		atomic_store_explicit(&msg->seq, _msgs_head + _MESSAGES_LEN, memory_order_release);
+		_msgs_head++;
+		if (is_signal) {
+			_RUN_FN(_fn_callback_loop_signal, serial);
+		} else {
+			_RUN_FN(_fn_callback_loop_message, serial, data);
+		}
+	}
 
-	return (_rect_t){.x = px, .y = py, .w = pw, .h = ph};
+	if (_init && _msgs_fd >= 0) {
+		n_wake = 1;
+		if (write(_msgs_fd, &n_wake, sizeof(n_wake)) < 0) {
+			n_wake = 0;
+		}
+	}
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 static bool
-_popup_grab_inputs(void)
+_loop_push_message(bool is_signal, uint32_t serial, void *data)
 {
-	bool fail = false;
+	_message_t *msg;
+	size_t seq;
+	size_t pos = atomic_load_explicit(&_msgs_tail, memory_order_relaxed);
 
-	/* no need to explicitely grab touch events as they get interpreted as pointer events after the grab */
-	/* this also means that multitouch won't work on popups                                              */
+	if (_msgs_fd < 0) {
+		return false;
+	}
+
+	/* claim a slot, a slot is free when its seq matches the claimed position, and it still holds an */
+	/* unread message when its seq is one lap behind, which means the queue is full                  */
+
+	for (;;) {
+		msg = &_msgs[pos % _MESSAGES_LEN];
+		seq = atomic_load_explicit(&msg->seq, memory_order_acquire);
+		if (seq == pos) {
+			if (atomic_compare_exchange_weak_explicit(
+				&_msgs_tail, &pos, pos + 1, memory_order_relaxed, memory_order_relaxed)) {
+				break;
+			}
+		} else if (seq < pos) {
+			return false;
+		} else {
+			pos = atomic_load_explicit(&_msgs_tail, memory_order_relaxed);
+		}
+	}
+
+	/* fill and publish the slot, then wake the loop up */
+
+	msg->is_signal = is_signal;
+	msg->serial    = serial;
+	msg->data      = data;
+
+	atomic_store_explicit(&msg->seq, pos + 1, memory_order_release);
+
+	/* once published the message will be received no matter what, so a failed wake-up is not reported */
+	/* the non-blocking eventfd only refuses a write when its counter is saturated, and a saturated    */
+	/* counter already means that the loop has a pending wake-up to drain the queue with               */
+
+	const uint64_t n_wake = 1;
+
+	(void)!write(_msgs_fd, &n_wake, sizeof(n_wake));
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_loop_run_epilogue(void)
+{
+	dg_core_stack_t stk;
+	dg_core_window_t *w;
+
+	/* present windows that have been marked, a present can mark a window again (like an immediate  */
+	/* redraw that leaves areas with pending updates) so repeat until there is nothing left to do    */
+
+	while (_windows_dirty.n > 0) {
+		stk = _windows_dirty;
+		_windows_dirty = DG_CORE_STACK_EMPTY;
+		for (size_t i = stk.n; i > 0; i--) {
+			w = (dg_core_window_t*)stk.ptr[i - 1];
+			w->present_queued = false;
+			_window_present(w);
+		}
+		dg_core_stack_reset(&stk);
+	}
+
+	/* destroy things that needs it, the pull in each destroy function shrinks the trash stacks */
+
+	while (_windows_trash.n > 0) {
+		_window_destroy((dg_core_window_t*)_windows_trash.ptr[_windows_trash.n - 1]);
+	}
+
+	while (_grids_trash.n > 0) {
+		_grid_destroy((dg_core_grid_t*)_grids_trash.ptr[_grids_trash.n - 1]);
+	}
+
+	while (_cells_trash.n > 0) {
+		_cell_destroy((dg_core_cell_t*)_cells_trash.ptr[_cells_trash.n - 1]);
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_loop_wait_events(void)
+{
+	xcb_generic_event_t *x_ev;
+	int n_ran = 0;
+
+	/* xcb may already hold events that have been read from the connection, so always check it first */
+
+	while (!(x_ev = xcb_poll_for_event(_x_con))) {
+
+		if (xcb_connection_has_error(_x_con)) {
+			return false;
+		}
+
+		/* a callback on a watched file descriptor is enough to end the wait */
+
+		if (n_ran > 0 || !_init || !_loop) {
+			return true;
+		}
+
+		/* sleep until something happens */
+
+		xcb_flush(_x_con);
+
+		n_ran = _loop_poll_fds(-1);
+		if (n_ran < 0) {
+			goto fallback;
+		}
+	}
+
+	goto push;
+
+fallback:
+
+	x_ev = xcb_wait_for_event(_x_con);
+	if (!x_ev) {
+		return false;
+	}
+
+push:
+
+	if (!dg_core_queue_push(&_events, x_ev)) {
+		free(x_ev);
+	}
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static _fd_watch_t *
+_loop_find_fd(int fd)
+{
+	for (size_t i = 0; i < _fds.n; i++) {
+		if (((_fd_watch_t*)_fds.ptr[i])->fd == fd) {
+			return (_fd_watch_t*)_fds.ptr[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static dg_core_window_t *
+_loop_find_window(xcb_window_t x_win)
+{
+	return (dg_core_window_t*)dg_core_map_get(&_windows_map, x_win);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_loop_no_active_windows(void)
+{
+	return _windows_n_active == 0;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_misc_get_input_swap(xcb_key_press_event_t *x_ev, dg_core_config_swap_t *swap)
+{
+	const uint8_t val  = x_ev->detail;
+	const uint8_t type = x_ev->response_type & ~0x80;
+
+	const bool is_key = type == XCB_KEY_PRESS || type == XCB_KEY_RELEASE;
+
+	/* get swap shift level */
+
+	int shift;
+
+	if (!(x_ev->state & DG_CORE_CONFIG->mod_meta)) {
+		shift = 0;
+	} else if (x_ev->state & XCB_MOD_MASK_SHIFT) {
+		shift = 2;
+	} else {
+		shift = 1;
+	}
+
+	/* get swap */
+
+	if ((is_key && val > DG_CORE_CONFIG_MAX_KEYS) || (!is_key && val > DG_CORE_CONFIG_MAX_BUTTONS)) {
+		return false;
+	}
+
+	*swap = is_key ? DG_CORE_CONFIG->swap_key[val][shift] : DG_CORE_CONFIG->swap_but[val][shift];
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_misc_reconfig(void)
+{
+	_render_wait();
+
+	dg_core_resource_load_all();
+
+	/* styles may have changed, so retained renderings are obsolete */
+
+	while (_retains_head) {
+		_retain_pull(_retains_head);
+	}
+
+	dg_core_window_t *w;
+	dg_core_grid_t *g;
+	dg_core_grid_t *g_min;
+
+	/* update all windows                                                */
+	/* resize them if they are smaller than their new minimun dimensions */
+
+	for (size_t i = 0; i < _windows.n; i++) {
+
+		w = (dg_core_window_t*)_windows.ptr[i];
+		g = w->g_current;
+		g_min = _window_find_smallest_grid(w);
+
+		if (!(w->state & DG_CORE_WINDOW_STATE_ACTIVE)) {
+			dg_core_window_reset_current_grid(w);
+			continue;
+		}
+
+		_window_update_geometries(w, w->p_container);
+		_window_update_current_grid(w);
+		_window_update_wm_size_hints(w);
+		_window_set_render_level(w, _WINDOW_RENDER_FULL);
+		_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
+
+		if (g->n_fwu == 0.0 || (g == g_min && g->pw > w->pw)) {
+			xcb_configure_window(_x_con, w->x_win, XCB_CONFIG_WINDOW_WIDTH, &g->pw);
+		}
+
+		if (g->n_fhu == 0.0 || (g == g_min && g->ph > w->ph)) {
+			xcb_configure_window(_x_con, w->x_win, XCB_CONFIG_WINDOW_HEIGHT, &g->ph);
+		}
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_pool_drain(void)
+{
+	/* cairo objects can't be shared between threads, so each one wraps the target's pixels on its own */
+
+	cairo_surface_t *c_srf = cairo_image_surface_create_for_data(
+		cairo_image_surface_get_data(_pool_c_srf),
+		cairo_image_surface_get_format(_pool_c_srf),
+		cairo_image_surface_get_width(_pool_c_srf),
+		cairo_image_surface_get_height(_pool_c_srf),
+		cairo_image_surface_get_stride(_pool_c_srf));
+
+	cairo_t *c_ctx = cairo_create(c_srf);
+	_area_job_t *job;
+	size_t i;
+
+	if (cairo_status(c_ctx) != CAIRO_STATUS_SUCCESS) {
+		dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
+		goto exit;
+	}
+
+	/* areas don't overlap, clipping them keeps each thread within its own pixels */
+
+	while ((i = atomic_fetch_add(&_pool_jobs_next, 1)) < _pool_jobs_n) {
+		job = _pool_jobs + i;
+		job->dc.c_ctx = c_ctx;
+		cairo_save(c_ctx);
+		cairo_rectangle(c_ctx, job->rect_clip.x, job->rect_clip.y, job->rect_clip.w, job->rect_clip.h);
+		cairo_clip(c_ctx);
+		cairo_set_operator(c_ctx, CAIRO_OPERATOR_SOURCE);
+		_RUN_FN(_fn_callback_draw_batch, c_ctx, true);
+		_cell_draw(job->a->c, &job->dc);
+		_RUN_FN(_fn_callback_draw_batch, c_ctx, false);
+		cairo_restore(c_ctx);
+		job->done = true;
+	}
+
+exit:
+
+	cairo_destroy(c_ctx);
+	cairo_surface_destroy(c_srf);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_pool_run(cairo_surface_t *c_srf)
+{
+	_pool_c_srf = c_srf;
+	atomic_store(&_pool_jobs_next, 0);
+
+	pthread_mutex_lock(&_pool_mutex);
+	_pool_round++;
+	_pool_busy = _pool_n;
+	pthread_cond_broadcast(&_pool_cond_work);
+	pthread_mutex_unlock(&_pool_mutex);
+
+	_pool_drain();
+
+	pthread_mutex_lock(&_pool_mutex);
+	while (_pool_busy > 0) {
+		pthread_cond_wait(&_pool_cond_done, &_pool_mutex);
+	}
+	pthread_mutex_unlock(&_pool_mutex);
+
+	_pool_c_srf = NULL;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_pool_start(void)
+{
+	const unsigned int size = DG_CORE_CONFIG->render_threads;
+
+	if (size == _pool_size) {
+		return _pool_n > 0;
+	}
+
+	/* (re)spawn workers to match the config */
+
+	_pool_stop();
+	_pool_size = size;
+
+	if (size <= 1) {
+		return false;
+	}
+
+	_pool_threads = malloc((size - 1) * sizeof(pthread_t));
+	if (!_pool_threads) {
+		dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+		return false;
+	}
+
+	while (_pool_n < size - 1 && pthread_create(_pool_threads + _pool_n, NULL, _pool_work, NULL) == 0) {
+		_pool_n++;
+	}
+
+	return _pool_n > 0;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_pool_stop(void)
+{
+	pthread_mutex_lock(&_pool_mutex);
+	_pool_quit = true;
+	pthread_cond_broadcast(&_pool_cond_work);
+	pthread_mutex_unlock(&_pool_mutex);
+
+	for (size_t i = 0; i < _pool_n; i++) {
+		pthread_join(_pool_threads[i], NULL);
+	}
+
+	free(_pool_threads);
+
+	/* new workers start counting rounds from 0 */
+
+	_pool_threads = NULL;
+	_pool_n       = 0;
+	_pool_size    = 0;
+	_pool_round   = 0;
+	_pool_quit    = false;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void *
+_pool_work(void *arg)
+{
+	(void)arg;
+
+	unsigned long round = 0;
+
+	pthread_mutex_lock(&_pool_mutex);
+
+	while (true) {
+		while (round == _pool_round && !_pool_quit) {
+			pthread_cond_wait(&_pool_cond_work, &_pool_mutex);
+		}
+		if (_pool_quit) {
+			break;
+		}
+		round = _pool_round;
+		pthread_mutex_unlock(&_pool_mutex);
+		_pool_drain();
+		pthread_mutex_lock(&_pool_mutex);
+		if (--_pool_busy == 0) {
+			pthread_cond_signal(&_pool_cond_done);
+		}
+	}
+
+	pthread_mutex_unlock(&_pool_mutex);
+
+	return NULL;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static _popup_t *
+_popup_find_under_coords(int16_t px, int16_t py)
+{
+	_popup_t *p = _p_last;
+
+	do {
+		if (dg_core_util_test_bounds(px, py, p->px, p->py, p->pw, p->ph)) {
+			return p;
+		}
+		p = p->p_parent;
+	} while (p);
+
+	return NULL;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static _rect_t
+_popup_get_geometry(dg_core_window_t *w_ref, int16_t px, int16_t px_alt, int16_t py_alt, int16_t py, 
+	int16_t pw, int16_t ph)
+{ 
+	if (w_ref) {
+		px += w_ref->px;
+		py += w_ref->py;
+		px_alt += w_ref->px;
+		py_alt += w_ref->py;
+	}
+
+	/* apply overrides and max geometry */
+
+	if (DG_CORE_CONFIG->popup_override_position) {
+		px = DG_CORE_CONFIG->popup_override_px;
+		py = DG_CORE_CONFIG->popup_override_py;
+		px_alt = DG_CORE_CONFIG->popup_override_px;
+		py_alt = DG_CORE_CONFIG->popup_override_py;
+	}
+
+	if (DG_CORE_CONFIG->popup_override_width && DG_CORE_CONFIG->popup_override_pw > 0) {
+		pw = DG_CORE_CONFIG->popup_override_pw;
+	} else if (DG_CORE_CONFIG->popup_max_pw > 0) {
+		pw = DG_CORE_CONFIG->popup_max_pw;
+	}
+
+	if (DG_CORE_CONFIG->popup_override_height && DG_CORE_CONFIG->popup_override_ph > 0) {
+		pw = DG_CORE_CONFIG->popup_override_ph;
+	} else if (DG_CORE_CONFIG->popup_max_ph > 0) {
+		pw = DG_CORE_CONFIG->popup_max_ph;
+	}
+
+	/* find which display will the popup appear on and retrieve its geometry */
+	/* thrn adjust the popup's geometry based on the monitor's geometry      */
+
+	_rect_t rect = _x_get_monitor_geometry_at(px, py);
+	if (rect.w <= 0 || rect.h <= 0) {
+		goto skip_adjust;
+	}
+
+	if (px + pw > rect.x + rect.w) {
+		px = px_alt - pw;
+	}
+
+	if (py + ph > rect.y + rect.h) {
+		py = py_alt - ph;
+	}
+
+	if (px < rect.x) {
+		px = rect.x;
+	}
+
+	if (py < rect.y) {
+		py = rect.y;
+	}
+
+	if (pw > rect.w) {
+		pw = rect.w;
+	}
+
+	if (ph > rect.h) {
+		ph = rect.h;
+	}
+
+skip_adjust:
+
+	/*****/
+
+	return (_rect_t){.x = px, .y = py, .w = pw, .h = ph};
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_popup_grab_inputs(void)
+{
+	bool fail = false;
+
+	/* no need to explicitely grab touch events as they get interpreted as pointer events after the grab */
+	/* this also means that multitouch won't work on popups                                              */
 
 	xcb_grab_keyboard_cookie_t xc1 =
 		xcb_grab_keyboard(
@@ -3600,150 +5334,744 @@ _popup_grab_inputs(void)
 			XCB_GRAB_MODE_ASYNC,
 			XCB_GRAB_MODE_ASYNC);
 
-	xcb_grab_pointer_cookie_t xc2 = 
-		xcb_grab_pointer(
-			_x_con,
-			0,
-			_x_scr->root,
-			XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION,
-			XCB_GRAB_MODE_ASYNC,
-			XCB_GRAB_MODE_ASYNC,
-			XCB_NONE,
-			XCB_NONE,
-			XCB_CURRENT_TIME);
+	xcb_grab_pointer_cookie_t xc2 = 
+		xcb_grab_pointer(
+			_x_con,
+			0,
+			_x_scr->root,
+			XCB_EVENT_MASK_BUTTON_PRESS | XCB_EVENT_MASK_BUTTON_RELEASE | XCB_EVENT_MASK_POINTER_MOTION,
+			XCB_GRAB_MODE_ASYNC,
+			XCB_GRAB_MODE_ASYNC,
+			XCB_NONE,
+			XCB_NONE,
+			XCB_CURRENT_TIME);
+
+	xcb_grab_keyboard_reply_t *xr1 = xcb_grab_keyboard_reply(_x_con, xc1, NULL);
+	xcb_grab_pointer_reply_t  *xr2 = xcb_grab_pointer_reply(_x_con,  xc2, NULL);
+
+	fail = !xr1 || !xr2;
+	fail = !xr2;
+	if (fail) {
+		dg_core_errno_set(DG_CORE_ERRNO_XCB);
+		_popup_ungrab_inputs();
+	}
+
+	free(xr1);
+	free(xr2);
+	
+	return !fail;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+_popup_kill(_popup_t *p)
+{
+	if (!p) {
+		return;
+	}
+
+	_popup_t *p_next;
+
+	_p_last = p->p_parent;
+	if (!_p_last) {
+		_popup_ungrab_inputs();
+	} else {
+		_p_last->p_child = NULL;
+	}
+
+	do {
+		p_next = p->p_child;
+		_p_hover = p_next == _p_hover ? NULL : _p_hover;
+		dg_core_grid_destroy((dg_core_grid_t*)p->w->grids.ptr[0]);
+		dg_core_window_destroy(p->w);
+		free(p);
+		p = p_next;
+	} while (p);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static dg_core_window_t *
+_popup_prep_core_input(xcb_key_press_event_t *x_ev)
+{
+	if (!_p_last || x_ev->event != _x_scr->root) {
+		return NULL;
+	}
+
+	uint8_t type = x_ev->response_type & ~0x80;
+
+	/* keyboard inputs, without coordinates, always goes to the last spawned popup */
+
+	if (type == XCB_KEY_PRESS || type == XCB_KEY_RELEASE) {
+		return _p_last->w;
+	}
+
+	/* check if an input was already ongoing                               */
+	/* if the button action was out of bounds of all popups, kill them all */
+	/* if the found popup is not the last one, kill all its childrens      */
+
+	_popup_t *p;
+
+	if (_p_last->w->buttons.n > 0) {
+		goto skip_search;
+	}
+
+	p = _popup_find_under_coords(x_ev->event_x, x_ev->event_y);
+	if (!p) {
+		dg_core_popup_kill_all();
+		return NULL;
+	} else if (p != _p_last) {
+		_popup_kill(p->p_child);
+		return NULL;
+	}
+
+skip_search:
+
+	/* transform input coordinates to popup's */
+
+	x_ev->event_x -= _p_last->px;
+	x_ev->event_y -= _p_last->py;
+
+	return _p_last->w;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static dg_core_window_t *
+_popup_prep_motion_input(xcb_motion_notify_event_t *x_ev)
+{
+	if (!_p_last || x_ev->event != _x_scr->root) {
+		return NULL;
+	}
+
+	/* check if an input was already ongoing                                             */
+	/* if it is use the popup that had the input, otherwhise find the popup under coords */
+
+	dg_core_cell_event_t cev = {.kind = DG_CORE_CELL_EVENT_FOCUS_LOSE};
+	_popup_t *p_prev = _p_hover;
+
+	if (!_p_hover || _p_hover->w->buttons.n == 0) {
+		_p_hover = _popup_find_under_coords(x_ev->event_x, x_ev->event_y);
+	}
+
+	if (p_prev && p_prev != _p_hover) {
+		_window_send_event_to_all(p_prev->w, &cev);
+	}
+
+	if (!_p_hover) {
+		return NULL;
+	}
+
+	/* transform input coordinates to popup's */
+
+	x_ev->event_x -= _p_hover->px;
+	x_ev->event_y -= _p_hover->py;
+
+	return _p_hover->w;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void 
+_popup_ungrab_inputs(void)
+{
+	_x_test_cookie(xcb_ungrab_keyboard_checked(_x_con, XCB_CURRENT_TIME), true);
+	_x_test_cookie(xcb_ungrab_pointer_checked(_x_con,  XCB_CURRENT_TIME), true);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_render_complete(void)
+{
+	dg_core_window_t *w = _frame.w;
+	_area_job_t *job;
+	size_t i = 0;
+
+	pthread_mutex_lock(&_render_mutex);
+	while (!_frame.drawn) {
+		pthread_cond_wait(&_render_cond, &_render_mutex);
+	}
+	_frame.w = NULL;
+	pthread_mutex_unlock(&_render_mutex);
+
+	atomic_store(&_render_abort, false);
+	cairo_surface_mark_dirty(_frame.c_srf);
+
+	/* hand retained renderings back to the cache, blank ones the render thread did not get to and ones  */
+	/* that can't be retained in the state they were drawn in are dropped, like in _area_draw_retained() */
+	/* until then, renderings being filled are left alone by the loop thread, even for other windows     */
+
+	_retained_t *r;
+
+	for (i = 0; i < _frame.n_jobs; i++) {
+		job = _frame.jobs + i;
+		if (!job->c_retained) {
+			continue;
+		}
+		r = _retain_find(job->a->c, &job->dc);
+		if (r && r->c_srf == job->c_retained && job->retain_fill) {
+			r->filling = false;
+			if (!job->done) {
+				_retain_pull(r);
+			} else if (job->dc.msg != DG_CORE_CELL_DRAW_MSG_NONE) {
+				_retains_size -= (size_t)r->pw * r->ph * 4;
+				cairo_surface_destroy(r->c_srf);
+				r->c_srf = NULL;
+			}
+		}
+		cairo_surface_destroy(job->c_retained);
+		job->c_retained = NULL;
+	}
+
+	_retain_trim();
+
+	/* cells the render thread had to give up on are drawn here, along with all the ones that came after */
+	/* them so that cells drawing out of their bounds still overlap in the same order                    */
+
+	i = 0;
+	while (i < _frame.n_jobs && _frame.jobs[i].done) {
+		i++;
+	}
+
+	if (i < _frame.n_jobs) {
+		_window_batch_draws(w, true);
+		for (; i < _frame.n_jobs; i++) {
+			job = _frame.jobs + i;
+			job->dc.msg = DG_CORE_CELL_DRAW_MSG_NONE;
+			_area_redraw_draw(job->a, w, job);
+		}
+		_window_batch_draws(w, false);
+	}
+
+	for (i = 0; i < _frame.n_jobs; i++) {
+		_area_redraw_finish(_frame.jobs[i].a, w, _frame.jobs + i);
+	}
+
+	/* requests made while the frame was in flight got no redraw of their own */
+
+	_window_redraw_end(w, _frame.i_back, _frame.delay);
+
+	if (w->render_level != _WINDOW_RENDER_NONE) {
+		_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_render_draw(void)
+{
+	cairo_surface_t *c_srf = cairo_image_surface_create_for_data(
+		cairo_image_surface_get_data(_frame.c_srf),
+		cairo_image_surface_get_format(_frame.c_srf),
+		cairo_image_surface_get_width(_frame.c_srf),
+		cairo_image_surface_get_height(_frame.c_srf),
+		cairo_image_surface_get_stride(_frame.c_srf));
+
+	cairo_t *c_ctx = cairo_create(c_srf);
+	_area_job_t *job;
+	dg_core_cell_t *c;
+
+	if (cairo_status(c_ctx) != CAIRO_STATUS_SUCCESS) {
+		dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
+		goto exit;
+	}
+
+	/* same drawing order, clipping and retained renderings as on the loop thread */
+	/* if the loop thread wants the frame back, remaining cells are left to it    */
+
+	for (size_t i = 0; i < _frame.n_jobs && !atomic_load(&_render_abort); i++) {
+		job = _frame.jobs + i;
+		c   = job->a->c;
+		if (!_render_lock_cell(c)) {
+			break;
+		}
+		job->dc.c_ctx = c_ctx;
+		cairo_save(c_ctx);
+		if (job->clip) {
+			cairo_rectangle(c_ctx, job->rect_clip.x, job->rect_clip.y, job->rect_clip.w, job->rect_clip.h);
+			cairo_clip(c_ctx);
+		}
+		cairo_set_operator(c_ctx, CAIRO_OPERATOR_SOURCE);
+		if (!job->c_retained || !_render_draw_retained(job, c_ctx)) {
+			_RUN_FN(_fn_callback_draw_batch, c_ctx, true);
+			c->fn_draw(c, &job->dc);
+			_RUN_FN(_fn_callback_draw_batch, c_ctx, false);
+		}
+		cairo_restore(c_ctx);
+		_cell_unlock(c);
+		job->done = true;
+	}
+
+exit:
+
+	cairo_destroy(c_ctx);
+	cairo_surface_destroy(c_srf);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_render_draw_retained(_area_job_t *job, cairo_t *c_ctx)
+{
+	dg_core_cell_drawing_context_t *dc = &job->dc;
+
+	const int16_t px = dc->cell_px;
+	const int16_t py = dc->cell_py;
+
+	/* the rendering was set up by _render_handoff(), if it is blank the cell is rendered offscreen first */
+
+	if (job->retain_fill) {
+		cairo_t *c_ctx_tmp = cairo_create(job->c_retained);
+		cairo_set_operator(c_ctx_tmp, CAIRO_OPERATOR_SOURCE);
+		dc->cell_px = 0;
+		dc->cell_py = 0;
+		dc->c_ctx   = c_ctx_tmp;
+		_RUN_FN(_fn_callback_draw_batch, c_ctx_tmp, true);
+		job->a->c->fn_draw(job->a->c, dc);
+		_RUN_FN(_fn_callback_draw_batch, c_ctx_tmp, false);
+		cairo_destroy(c_ctx_tmp);
+		dc->cell_px = px;
+		dc->cell_py = py;
+		dc->c_ctx   = c_ctx;
+	}
+
+	/* blit */
+
+	cairo_set_source_surface(c_ctx, job->c_retained, dc->cell_px, dc->cell_py);
+	cairo_rectangle(c_ctx, dc->cell_px, dc->cell_py, dc->cell_pw, dc->cell_ph);
+	cairo_fill(c_ctx);
+
+	/* out of bounds drawings got cut by the offscreen surface, so they're drawn again on the window */
+
+	return !(dc->msg & DG_CORE_CELL_DRAW_MSG_OUT_OF_BOUNDS);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_render_handoff(dg_core_window_t *w, size_t i_back, unsigned long delay)
+{
+	if (_frame.w || !w->img.c_srf || !_render_start()) {
+		return false;
+	}
+
+	_area_t *a;
+
+	/* every cell about to be drawn has to be fine with being drawn off the loop thread */
+
+	const bool full = w->render_level == _WINDOW_RENDER_FULL;
+	const size_t n = full ? w->g_current->areas.n : w->g_current->n_dirty;
+
+	for (size_t i = 0; i < n; i++) {
+		a = full ? (_area_t*)w->g_current->areas.ptr[i] : w->g_current->dirty[i];
+		if (!a->c->threaded) {
+			return false;
+		}
+	}
+
+	if (_frame.n_jobs_alloc < w->g_current->areas.n) {
+		_area_job_t *jobs = realloc(_frame.jobs, w->g_current->areas.n * sizeof(_area_job_t));
+		if (!jobs) {
+			dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+			return false;
+		}
+		_frame.jobs         = jobs;
+		_frame.n_jobs_alloc = w->g_current->areas.n;
+	}
+
+	/* same order as _window_redraw */
+
+	_frame.n_jobs = 0;
+
+	for (size_t i = 0, n = _window_list_areas(w, DG_CORE_CELL_FOCUS_NONE); i < n; i++) {
+		if (_area_redraw_prepare(_draws[i], w, delay, _frame.jobs + _frame.n_jobs)) {
+			_frame.n_jobs++;
+		}
+	}
+
+	for (size_t i = 0, n = _window_list_areas(w, DG_CORE_CELL_FOCUS_SECONDARY); i < n; i++) {
+		if (_area_redraw_prepare(_draws[i], w, delay, _frame.jobs + _frame.n_jobs)) {
+			_frame.n_jobs++;
+		}
+	}
+
+	if (w->a_focus && _area_redraw_prepare(w->a_focus, w, delay, _frame.jobs + _frame.n_jobs)) {
+		_frame.n_jobs++;
+	}
+
+	if (_frame.n_jobs == 0) {
+		return false;
+	}
+
+	/* the retained cache belongs to the loop thread, so renderings are looked up or set up blank here */
+
+	_area_job_t *job;
+	_retained_t *r;
+	bool fill;
+
+	for (size_t i = 0; i < _frame.n_jobs && DG_CORE_CONFIG->retain_budget > 0; i++) {
+		job = _frame.jobs + i;
+		if (job->clip || !job->a->c->retained) {
+			continue;
+		}
+		r    = _retain_find(job->a->c, &job->dc);
+		fill = !r;
+		if (fill) {
+			r = _retain_create(job->a->c, &job->dc, w->c_srf);
+		}
+		if (r && r->c_srf && !r->filling) {
+			job->c_retained  = cairo_surface_reference(r->c_srf);
+			job->retain_fill = fill;
+			r->filling       = fill;
+			_retain_use(r);
+		}
+	}
+
+	/* background and border have to land before the render thread writes pixels */
+
+	cairo_surface_flush(w->c_srf);
+
+	pthread_mutex_lock(&_render_mutex);
+	_frame.w      = w;
+	_frame.c_srf  = w->c_srf;
+	_frame.i_back = i_back;
+	_frame.delay  = delay;
+	_frame.drawn  = false;
+	pthread_cond_broadcast(&_render_cond);
+	pthread_mutex_unlock(&_render_mutex);
+
+	/* the frame is consumed, anything requested from now on is for the next one */
+
+	w->present_schedule = _WINDOW_PRESENT_NONE;
+	w->render_level     = _WINDOW_RENDER_NONE;
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_render_lock_cell(dg_core_cell_t *c)
+{
+	bool locked = true;
+
+	/* sleep until _cell_unlock() lets go of the cell or the loop thread wants the frame back */
+
+	pthread_mutex_lock(&_render_mutex);
+	atomic_store(&_render_blocked, c);
+	atomic_thread_fence(memory_order_seq_cst);
+
+	while (pthread_mutex_trylock(&c->mutex) != 0) {
+		if (atomic_load(&_render_abort)) {
+			locked = false;
+			break;
+		}
+		pthread_cond_wait(&_render_cond, &_render_mutex);
+	}
+
+	atomic_store(&_render_blocked, NULL);
+	pthread_mutex_unlock(&_render_mutex);
+
+	return locked;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_render_process(int fd, short revents)
+{
+	(void)revents;
+
+	uint64_t n_wake;
+	bool drawn;
+
+	if (read(fd, &n_wake, sizeof(n_wake)) < 0) {
+		n_wake = 0;
+	}
+
+	/* the frame may have already been completed by _render_wait() */
+
+	pthread_mutex_lock(&_render_mutex);
+	drawn = _frame.w && _frame.drawn;
+	pthread_mutex_unlock(&_render_mutex);
+
+	if (drawn) {
+		_render_complete();
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_render_start(void)
+{
+	if (_render_running) {
+		return true;
+	}
+
+	if (!DG_CORE_CONFIG->render_thread) {
+		return false;
+	}
+
+	/* the eventfd tells the loop when a frame is ready to be presented */
+
+	_render_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (_render_fd < 0) {
+		dg_core_errno_set(DG_CORE_ERRNO_DEPENDENCY);
+		return false;
+	}
+
+	if (!dg_core_loop_add_fd(_render_fd, POLLIN, _render_process)) {
+		goto fail_fd;
+	}
+
+	if (pthread_create(&_render_thread, NULL, _render_work, NULL) != 0) {
+		dg_core_errno_set(DG_CORE_ERRNO_DEPENDENCY);
+		goto fail_thread;
+	}
+
+	_render_running = true;
+
+	return true;
+
+	/* errors */
+
+fail_thread:
+	dg_core_loop_remove_fd(_render_fd);
+fail_fd:
+	close(_render_fd);
+	_render_fd = -1;
+	return false;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-	xcb_grab_keyboard_reply_t *xr1 = xcb_grab_keyboard_reply(_x_con, xc1, NULL);
-	xcb_grab_pointer_reply_t  *xr2 = xcb_grab_pointer_reply(_x_con,  xc2, NULL);
+static void
+_render_stop(void)
+{
+	/* a frame still in flight is dropped, the windows are about to go away anyway */
 
-	fail = !xr1 || !xr2;
-	fail = !xr2;
-	if (fail) {
-		dg_core_errno_set(DG_CORE_ERRNO_XCB);
-		_popup_ungrab_inputs();
+	if (_render_running) {
+		atomic_store(&_render_abort, true);
+		pthread_mutex_lock(&_render_mutex);
+		_render_quit = true;
+		pthread_cond_broadcast(&_render_cond);
+		pthread_mutex_unlock(&_render_mutex);
+		pthread_join(_render_thread, NULL);
 	}
 
-	free(xr1);
-	free(xr2);
-	
-	return !fail;
+	if (_render_fd >= 0) {
+		close(_render_fd);
+	}
+
+	for (size_t i = 0; _frame.w && i < _frame.n_jobs; i++) {
+		cairo_surface_destroy(_frame.jobs[i].c_retained);
+	}
+
+	free(_frame.jobs);
+
+	_render_running = false;
+	_render_quit    = false;
+	_render_fd      = -1;
+	_frame          = (_frame_t){0};
+
+	atomic_store(&_render_abort, false);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-void
-_popup_kill(_popup_t *p)
+static void
+_render_wait(void)
 {
-	if (!p) {
+	if (!_frame.w) {
 		return;
 	}
 
-	_popup_t *p_next;
+	pthread_mutex_lock(&_render_mutex);
+	atomic_store(&_render_abort, true);
+	pthread_cond_broadcast(&_render_cond);
+	pthread_mutex_unlock(&_render_mutex);
 
-	_p_last = p->p_parent;
-	if (!_p_last) {
-		_popup_ungrab_inputs();
-	} else {
-		_p_last->p_child = NULL;
+	_render_complete();
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void *
+_render_work(void *arg)
+{
+	(void)arg;
+
+	uint64_t n_wake = 1;
+
+	pthread_mutex_lock(&_render_mutex);
+
+	while (true) {
+		while ((!_frame.w || _frame.drawn) && !_render_quit) {
+			pthread_cond_wait(&_render_cond, &_render_mutex);
+		}
+		if (_render_quit) {
+			break;
+		}
+		pthread_mutex_unlock(&_render_mutex);
+		_render_draw();
+		pthread_mutex_lock(&_render_mutex);
+		_frame.drawn = true;
+		pthread_cond_broadcast(&_render_cond);
+		if (write(_render_fd, &n_wake, sizeof(n_wake)) < 0) {
+			dg_core_errno_set(DG_CORE_ERRNO_DEPENDENCY);
+		}
 	}
 
-	do {
-		p_next = p->p_child;
-		_p_hover = p_next == _p_hover ? NULL : _p_hover;
-		dg_core_grid_destroy((dg_core_grid_t*)p->w->grids.ptr[0]);
-		dg_core_window_destroy(p->w);
-		free(p);
-		p = p_next;
-	} while (p);
+	pthread_mutex_unlock(&_render_mutex);
+
+	return NULL;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static dg_core_window_t *
-_popup_prep_core_input(xcb_key_press_event_t *x_ev)
+static void
+_retain_clear(dg_core_cell_t *c)
 {
-	if (!_p_last || x_ev->event != _x_scr->root) {
-		return NULL;
+	while (c->retains.n > 0) {
+		_retain_pull((_retained_t*)c->retains.ptr[c->retains.n - 1]);
 	}
+}
 
-	uint8_t type = x_ev->response_type & ~0x80;
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-	/* keyboard inputs, without coordinates, always goes to the last spawned popup */
+static _retained_t *
+_retain_create(dg_core_cell_t *c, const dg_core_cell_drawing_context_t *dc, cairo_surface_t *c_srf_ref)
+{
+	_retained_t *r = malloc(sizeof(_retained_t));
+	if (!r) {
+		dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+		goto fail_alloc;
+	}
 
-	if (type == XCB_KEY_PRESS || type == XCB_KEY_RELEASE) {
-		return _p_last->w;
+	r->c_srf = cairo_surface_create_similar(c_srf_ref, CAIRO_CONTENT_COLOR_ALPHA, dc->cell_pw, dc->cell_ph);
+	if (cairo_surface_status(r->c_srf) != CAIRO_STATUS_SUCCESS) {
+		dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
+		goto fail_surface;
 	}
 
-	/* check if an input was already ongoing                               */
-	/* if the button action was out of bounds of all popups, kill them all */
-	/* if the found popup is not the last one, kill all its childrens      */
+	if (!dg_core_stack_push(&c->retains, r, NULL)) {
+		goto fail_surface;
+	}
 
-	_popup_t *p;
+	r->c       = c;
+	r->pw      = dc->cell_pw;
+	r->ph      = dc->cell_ph;
+	r->focus   = dc->focus;
+	r->ena     = dc->is_enabled;
+	r->win_ena = dc->win_is_enabled;
+	r->filling = false;
 
-	if (_p_last->w->buttons.n > 0) {
-		goto skip_search;
-	}
+	/* insert as the most recently used */
 
-	p = _popup_find_under_coords(x_ev->event_x, x_ev->event_y);
-	if (!p) {
-		dg_core_popup_kill_all();
-		return NULL;
-	} else if (p != _p_last) {
-		_popup_kill(p->p_child);
-		return NULL;
+	r->prev = NULL;
+	r->next = _retains_head;
+	if (_retains_head) {
+		_retains_head->prev = r;
+	} else {
+		_retains_tail = r;
 	}
 
-skip_search:
+	_retains_head  = r;
+	_retains_size += (size_t)r->pw * r->ph * 4;
 
-	/* transform input coordinates to popup's */
+	return r;
 
-	x_ev->event_x -= _p_last->px;
-	x_ev->event_y -= _p_last->py;
+	/* errors */
 
-	return _p_last->w;
+fail_surface:
+	cairo_surface_destroy(r->c_srf);
+	free(r);
+fail_alloc:
+	return NULL;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static dg_core_window_t *
-_popup_prep_motion_input(xcb_motion_notify_event_t *x_ev)
+static _retained_t *
+_retain_find(dg_core_cell_t *c, const dg_core_cell_drawing_context_t *dc)
 {
-	if (!_p_last || x_ev->event != _x_scr->root) {
-		return NULL;
+	_retained_t *r;
+
+	for (size_t i = 0; i < c->retains.n; i++) {
+		r = (_retained_t*)c->retains.ptr[i];
+		if (r->pw == dc->cell_pw && r->ph == dc->cell_ph && r->focus == dc->focus &&
+		    r->ena == dc->is_enabled && r->win_ena == dc->win_is_enabled) {
+			return r;
+		}
 	}
 
-	/* check if an input was already ongoing                                             */
-	/* if it is use the popup that had the input, otherwhise find the popup under coords */
+	return NULL;
+}
 
-	dg_core_cell_event_t cev = {.kind = DG_CORE_CELL_EVENT_FOCUS_LOSE};
-	_popup_t *p_prev = _p_hover;
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-	if (!_p_hover || _p_hover->w->buttons.n == 0) {
-		_p_hover = _popup_find_under_coords(x_ev->event_x, x_ev->event_y);
+static void
+_retain_pull(_retained_t *r)
+{
+	if (r->prev) {
+		r->prev->next = r->next;
+	} else {
+		_retains_head = r->next;
 	}
 
-	if (p_prev && p_prev != _p_hover) {
-		_window_send_event_to_all(p_prev->w, &cev);
+	if (r->next) {
+		r->next->prev = r->prev;
+	} else {
+		_retains_tail = r->prev;
 	}
 
-	if (!_p_hover) {
-		return NULL;
+	if (r->c_srf) {
+		_retains_size -= (size_t)r->pw * r->ph * 4;
+		cairo_surface_destroy(r->c_srf);
 	}
 
-	/* transform input coordinates to popup's */
+	dg_core_stack_pull(&r->c->retains, r);
+	free(r);
+}
 
-	x_ev->event_x -= _p_hover->px;
-	x_ev->event_y -= _p_hover->py;
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-	return _p_hover->w;
+static void
+_retain_trim(void)
+{
+	const size_t budget = (size_t)DG_CORE_CONFIG->retain_budget * 1024;
+
+	while (_retains_size > budget && _retains_tail) {
+		_retain_pull(_retains_tail);
+	}
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static void 
-_popup_ungrab_inputs(void)
+static void
+_retain_use(_retained_t *r)
 {
-	_x_test_cookie(xcb_ungrab_keyboard_checked(_x_con, XCB_CURRENT_TIME), true);
-	_x_test_cookie(xcb_ungrab_pointer_checked(_x_con,  XCB_CURRENT_TIME), true);
+	if (!r->prev) {
+		return;
+	}
+
+	/* move to the front */
+
+	r->prev->next = r->next;
+	if (r->next) {
+		r->next->prev = r->prev;
+	} else {
+		_retains_tail = r->prev;
+	}
+
+	r->prev = NULL;
+	r->next = _retains_head;
+	_retains_head->prev = r;
+	_retains_head = r;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -3802,7 +6130,8 @@ _sub_event_action_cell(dg_core_window_t *w, dg_core_config_action_t action)
 
 		case DG_CORE_CONFIG_ACTION_CELL_REDRAW:
 			if (w->a_focus) {
-				w->a_focus->redraw = true;
+				_retain_clear(w->a_focus->c);
+				_area_request_redraw(w->a_focus, NULL);
 				_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
 				_window_set_render_level(w, _WINDOW_RENDER_AREAS);
 			}
@@ -4250,38 +6579,199 @@ _sub_event_touch_end(dg_core_window_t *w, uint32_t id, int16_t px, int16_t py)
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 static void
-_sub_event_touch_update(dg_core_window_t *w, uint32_t id, int16_t px, int16_t py)
+_sub_event_touch_update(dg_core_window_t *w, uint32_t id, int16_t px, int16_t py)
+{
+	_area_t *a;
+	size_t pos;
+
+	/* locate area on which the touch was started      */
+	/* then check if the touch is tracked in said area */
+
+	pos = 0;
+	if (!dg_core_input_buffer_find(&w->touches, id, &pos)) {
+		return;
+	}
+
+	pos = 0;
+	a = (_area_t*)w->touches.inputs[pos].ref;
+	if (!dg_core_input_buffer_find(&a->touches, id, &pos)) {
+		return;
+	}
+	
+	/* send touch event */
+
+	dg_core_cell_event_t cev = {
+		.kind = DG_CORE_CELL_EVENT_TOUCH_UPDATE,
+		.touch_id = id,
+		.touch_px = px,
+		.touch_py = py,
+		.touch_dpx = px - a->touches.inputs[pos].x,
+		.touch_dpy = py - a->touches.inputs[pos].y,
+		.touch_n   = a->touches.n,
+	};
+
+	_window_process_cell_event(w, a, &cev);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_timer_arm(void)
+{
+	struct itimerspec its = {0};
+
+	/* an empty it_value disarms the timerfd */
+
+	if (_timers_heap_n > 0) {
+		its.it_value.tv_sec  = _timers_heap[0]->deadline / 1000000;
+		its.it_value.tv_nsec = _timers_heap[0]->deadline % 1000000 * 1000;
+		if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) {
+			its.it_value.tv_nsec = 1;
+		}
+	}
+
+	timerfd_settime(_timers_fd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_timer_heap_pull(dg_core_timer_t *t)
+{
+	const size_t i = t->heap_id;
+
+	t->heap_id = SIZE_MAX;
+
+	/* move the last timer in the freed slot and restore heap order from there */
+
+	if (--_timers_heap_n == i) {
+		return;
+	}
+
+	_timers_heap[i] = _timers_heap[_timers_heap_n];
+	_timers_heap[i]->heap_id = i;
+
+	_timer_heap_sift(i);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_timer_heap_push(dg_core_timer_t *t)
+{
+	if (_timers_heap_n >= _timers_heap_n_alloc) {
+		const size_t n_alloc = _timers_heap_n_alloc > 0 ? _timers_heap_n_alloc * 2 : 4;
+		void *tmp = realloc(_timers_heap, n_alloc * sizeof(dg_core_timer_t*));
+		if (!tmp) {
+			dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+			return false;
+		}
+		_timers_heap = tmp;
+		_timers_heap_n_alloc = n_alloc;
+	}
+
+	t->heap_id = _timers_heap_n;
+	_timers_heap[_timers_heap_n++] = t;
+
+	_timer_heap_sift(t->heap_id);
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_timer_heap_sift(size_t i)
+{
+	dg_core_timer_t *t = _timers_heap[i];
+	size_t j;
+
+	/* sift up, towards earlier deadlines */
+
+	while (i > 0 && _timers_heap[(j = (i - 1) / 2)]->deadline > t->deadline) {
+		_timers_heap[i] = _timers_heap[j];
+		_timers_heap[i]->heap_id = i;
+		i = j;
+	}
+
+	/* sift down, towards later deadlines */
+
+	while ((j = i * 2 + 1) < _timers_heap_n) {
+		if (j + 1 < _timers_heap_n && _timers_heap[j + 1]->deadline < _timers_heap[j]->deadline) {
+			j++;
+		}
+		if (_timers_heap[j]->deadline >= t->deadline) {
+			break;
+		}
+		_timers_heap[i] = _timers_heap[j];
+		_timers_heap[i]->heap_id = i;
+		i = j;
+	}
+
+	_timers_heap[i] = t;
+	t->heap_id = i;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_timer_process(int fd, short revents)
+{
+	uint64_t n_exp;
+	dg_core_timer_t *t;
+
+	/* clear timerfd expiration counter, the heap is the only source of truth */
+
+	if (read(fd, &n_exp, sizeof(n_exp)) < 0) {
+		n_exp = 0;
+	}
+
+	/* run all timers whose deadline passed. They are rescheduled or stopped before their callback runs, */
+	/* so a callback can freely restart, stop or destroy any timer, including its own                    */
+
+	const unsigned long now = dg_core_util_get_time();
+
+	while (_init && _timers_heap_n > 0 && _timers_heap[0]->deadline <= now) {
+		t = _timers_heap[0];
+		if (t->period > 0) {
+			t->deadline += t->period;
+			if (t->deadline <= now) {
+				t->deadline = now + t->period - (now - t->deadline) % t->period;
+			}
+			_timer_heap_sift(0);
+		} else {
+			_timer_heap_pull(t);
+		}
+		t->fn(t);
+	}
+
+	if (_init) {
+		_timer_arm();
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_window_add_damage(dg_core_window_t *w, _rect_t rect)
 {
-	_area_t *a;
-	size_t pos;
-
-	/* locate area on which the touch was started      */
-	/* then check if the touch is tracked in said area */
-
-	pos = 0;
-	if (!dg_core_input_buffer_find(&w->touches, id, &pos)) {
+	if (!w->img.damage) {
 		return;
 	}
 
-	pos = 0;
-	a = (_area_t*)w->touches.inputs[pos].ref;
-	if (!dg_core_input_buffer_find(&a->touches, id, &pos)) {
-		return;
-	}
-	
-	/* send touch event */
+	const cairo_rectangle_int_t r = {rect.x, rect.y, rect.w, rect.h};
 
-	dg_core_cell_event_t cev = {
-		.kind = DG_CORE_CELL_EVENT_TOUCH_UPDATE,
-		.touch_id = id,
-		.touch_px = px,
-		.touch_py = py,
-		.touch_dpx = px - a->touches.inputs[pos].x,
-		.touch_dpy = py - a->touches.inputs[pos].y,
-		.touch_n   = a->touches.n,
-	};
+	cairo_region_union_rectangle(w->img.damage, &r);
+}
 
-	_window_process_cell_event(w, a, &cev);
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_window_batch_draws(dg_core_window_t *w, bool open)
+{
+	if (_fn_callback_draw_batch) {
+		_fn_callback_draw_batch(w->c_ctx, open);
+	}
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -4297,16 +6787,42 @@ _window_destroy(dg_core_window_t *w)
 
 	_window_send_event_to_all(w, &cev);
 
-	cairo_destroy(w->c_ctx);
-	cairo_surface_destroy(w->c_srf);
+	_window_reset_buffers(w);
+	xcb_free_gc(_x_con, w->x_gc);
 
 	_x_test_cookie(xcb_unmap_window_checked(_x_con, w->x_win),   true);
 	_x_test_cookie(xcb_destroy_window_checked(_x_con, w->x_win), true);
 
 	dg_core_input_buffer_reset(&w->buttons);
 	dg_core_input_buffer_reset(&w->touches);
+
+	for (size_t i = 0; i < w->grids.n; i++) {
+		((dg_core_grid_t*)w->grids.ptr[i])->w_parent = NULL;
+	}
+
 	dg_core_stack_reset(&w->grids);
-	dg_core_stack_pull(&_windows, w);
+	dg_core_slotmap_pull(&_windows, w->id);
+	if (w->present_queued) {
+		dg_core_stack_pull(&_windows_dirty, w);
+	}
+	dg_core_map_unset(&_windows_map, w->x_win);
+
+	if (w->state & DG_CORE_WINDOW_STATE_ACTIVE) {
+		_windows_n_active--;
+	}
+
+	if (w->pace_timer) {
+		dg_core_timer_destroy(w->pace_timer);
+	}
+
+	_window_wake_clear(w);
+	free(w->wakes);
+
+	if (w->wake_timer) {
+		dg_core_timer_destroy(w->wake_timer);
+	}
+
+	dg_core_stack_pull(&_windows_trash, w);
 	free(w);
 }
 
@@ -4327,10 +6843,37 @@ _window_create(bool fixed, bool redirect)
 
 	w->render_level     = _WINDOW_RENDER_NONE;
 	w->present_schedule = _WINDOW_PRESENT_NONE;
+	w->present_queued   = false;
 	w->present_serial   = 0;
 	w->last_render_time = 0;
 
-	w->id          = 0;
+	w->render_cost  = 0;
+	w->msc_period   = 0;
+	w->msc_ust      = 0;
+	w->msc          = 0;
+	w->msc_target   = 0;
+	w->divider_rise = 0;
+	w->on_time      = 0;
+	w->missed       = 0;
+	w->low_latency  = false;
+	w->pace_timer   = NULL;
+
+	w->wakes         = NULL;
+	w->n_wakes       = 0;
+	w->n_wakes_alloc = 0;
+	w->wake_timer    = NULL;
+
+	w->c_ctx   = NULL;
+	w->c_srf   = NULL;
+	w->i_front = SIZE_MAX;
+	w->frame   = 0;
+
+	for (size_t i = 0; i < _WINDOW_BUFFERS; i++) {
+		w->bufs[i] = (_window_buffer_t){.x_pix = 0, .c_srf = NULL, .c_ctx = NULL, .frame = 0, .idle = true, .target_msc = 0};
+	}
+
+	w->img = (_window_image_t){.x_seg = 0, .data = NULL, .c_srf = NULL, .c_ctx = NULL, .damage = NULL, .n_pushes = 0, .pending = false};
+
 	w->to_destroy  = false;
 	w->name        = _class[0];
 	w->name_icon   = _class[0];
@@ -4409,29 +6952,25 @@ _window_create(bool fixed, bool redirect)
 		goto fail_x_win;
 	}
 
-	/* setup a cairo front surface linked to the window */
+	/* setup the swapchain the window's content is rendered into, then flipped with Present */
 
-	w->c_srf = cairo_xcb_surface_create(_x_con, w->x_win, _x_vis, w->pw, w->ph);
-	if (cairo_surface_status(w->c_srf) != CAIRO_STATUS_SUCCESS) {
-		dg_core_errno_set(DG_CORE_ERRNO_CAIRO_CRIT);
-		goto fail_cairo_srf;
-	}
+	const uint32_t gc_vals[] = {0};
 
-	w->c_ctx = cairo_create(w->c_srf);
-	if (cairo_status(w->c_ctx) != CAIRO_STATUS_SUCCESS) {
+	w->x_gc = xcb_generate_id(_x_con);
+	xcb_create_gc(_x_con, w->x_gc, w->x_win, XCB_GC_GRAPHICS_EXPOSURES, gc_vals);
+
+	if (!_window_update_buffers(w)) {
 		dg_core_errno_set(DG_CORE_ERRNO_CAIRO_CRIT);
-		goto fail_cairo_ctx;
+		goto fail_buffers_swap;
 	}
 
-	cairo_set_operator(w->c_ctx, CAIRO_OPERATOR_SOURCE);
-
 	/* indicate that the window should receive Present extension events */
 
 	xc = xcb_present_select_input_checked(
 		_x_con,
 		xcb_generate_id(_x_con),
 		w->x_win,
-		XCB_PRESENT_EVENT_MASK_COMPLETE_NOTIFY);
+		XCB_PRESENT_EVENT_MASK_COMPLETE_NOTIFY | XCB_PRESENT_EVENT_MASK_IDLE_NOTIFY);
 
 	if (_x_test_cookie(xc, false)) {
 		dg_core_errno_set(DG_CORE_ERRNO_XCB_CRIT);
@@ -4462,7 +7001,12 @@ _window_create(bool fixed, bool redirect)
 
 	/* add new window to session */
 
-	if (!dg_core_stack_push(&_windows, w, &w->id)) {
+	if (!dg_core_slotmap_push(&_windows, w, &w->id)) {
+		goto fail_push;
+	}
+
+	if (!dg_core_map_set(&_windows_map, w->x_win, w)) {
+		dg_core_slotmap_pull(&_windows, w->id);
 		goto fail_push;
 	}
 
@@ -4498,7 +7042,6 @@ _window_create(bool fixed, bool redirect)
 
 	/* end */
 
-	cairo_surface_flush(w->c_srf);
 	xcb_flush(_x_con);
 
 	return w;
@@ -4508,10 +7051,9 @@ _window_create(bool fixed, bool redirect)
 fail_push:
 fail_xi:
 fail_present:
-	cairo_destroy(w->c_ctx);
-fail_cairo_ctx:
-	cairo_surface_destroy(w->c_srf);
-fail_cairo_srf:
+fail_buffers_swap:
+	_window_reset_buffers(w);
+	xcb_free_gc(_x_con, w->x_gc);
 	xcb_destroy_window(_x_con, w->x_win);
 fail_x_win:
 	xcb_flush(_x_con);
@@ -4544,6 +7086,22 @@ _window_find_area_under_coords(dg_core_window_t *w, int16_t px, int16_t py)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static size_t
+_window_find_idle_buffer(dg_core_window_t *w)
+{
+	/* with the SHM backend pixmaps have no cairo context of their own, the image is pushed into them */
+
+	for (size_t i = 0; i < _WINDOW_BUFFERS; i++) {
+		if ((w->img.c_srf ? w->bufs[i].x_pix != 0 : w->bufs[i].c_ctx != NULL) && w->bufs[i].idle && i != w->i_front) {
+			return i;
+		}
+	}
+
+	return SIZE_MAX;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static dg_core_grid_t *
 _window_find_smallest_grid(dg_core_window_t *w)
 {
@@ -4610,6 +7168,130 @@ _window_get_border_color(dg_core_window_t *w)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static size_t
+_window_list_areas(dg_core_window_t *w, dg_core_cell_focus_t focus)
+{
+	/* a full render goes through every area, otherwise only the dirty set of the grid is looked at */
+
+	dg_core_grid_t *g = w->g_current;
+
+	const bool full = w->render_level == _WINDOW_RENDER_FULL;
+	const size_t n = full ? g->areas.n : g->n_dirty;
+
+	if (_draws_n_alloc < n) {
+		_area_t **draws = realloc(_draws, g->areas.n * sizeof(_area_t*));
+		if (!draws) {
+			dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+			return 0;
+		}
+		_draws         = draws;
+		_draws_n_alloc = g->areas.n;
+	}
+
+	size_t n_draws = 0;
+	_area_t *a;
+
+	for (size_t i = 0; i < n; i++) {
+		a = full ? (_area_t*)g->areas.ptr[i] : g->dirty[i];
+		if (_area_get_focus_type(a, w) == focus) {
+			_draws[n_draws++] = a;
+		}
+	}
+
+	return n_draws;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_window_pace(dg_core_window_t *w, uint64_t msc, unsigned long ust)
+{
+	const unsigned long now = dg_core_util_get_time();
+
+	/* notifications come every divider MSCs, which gives away the refresh period */
+
+	if (w->msc > 0 && msc > w->msc && ust > w->msc_ust) {
+		w->msc_period = (ust - w->msc_ust) / (msc - w->msc);
+	}
+
+	w->msc     = msc;
+	w->msc_ust = ust;
+
+	/* low latency windows and unsynced ones render right away, so do late notifications or unknown timings */
+
+	if (w->low_latency || DG_CORE_CONFIG->anim_divider == 0 || w->msc_period == 0 || ust > now ||
+	    now - ust >= w->msc_period) {
+		w->msc_target = 0;
+		_window_redraw(w);
+		return;
+	}
+
+	/* otherwise start rendering as late as possible while still making it to the next vblank */
+
+	w->msc_target = msc + 1;
+
+	const unsigned long budget = w->render_cost + _PACE_MARGIN;
+	const unsigned long start  = budget < w->msc_period ? ust + w->msc_period - budget : ust;
+
+	if (start <= now) {
+		_window_redraw(w);
+		return;
+	}
+
+	if (!w->pace_timer) {
+		w->pace_timer = dg_core_timer_create(_window_pace_expire, w);
+	}
+
+	if (!w->pace_timer || !dg_core_timer_start(w->pace_timer, start - now, 0)) {
+		_window_redraw(w);
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_window_pace_account(dg_core_window_t *w, uint32_t serial, uint64_t msc)
+{
+	_window_buffer_t *b = NULL;
+
+	for (size_t i = 0; i < _WINDOW_BUFFERS; i++) {
+		if (w->bufs[i].frame == serial) {
+			b = &w->bufs[i];
+		}
+	}
+
+	if (!b || b->target_msc == 0) {
+		return;
+	}
+
+	/* rather than letting late frames pile up, lower the framerate until the window keeps up again */
+
+	if (msc > b->target_msc) {
+		w->missed++;
+		w->on_time = 0;
+		if (w->divider_rise < _PACE_MAX_RISE) {
+			w->divider_rise++;
+		}
+	} else if (++w->on_time >= _PACE_RECOVERY && w->divider_rise > 0) {
+		w->divider_rise--;
+		w->on_time = 0;
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_window_pace_expire(dg_core_timer_t *t)
+{
+	dg_core_window_t *w = (dg_core_window_t*)dg_core_timer_get_props(t);
+
+	if (w->g_current) {
+		_window_redraw(w);
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static void
 _window_present(dg_core_window_t *w)
 {
@@ -4623,11 +7305,18 @@ _window_present(dg_core_window_t *w)
 			break;
 
 		case _WINDOW_PRESENT_IMMEDIATE:
+			w->msc_target = 0;
 			_window_redraw(w);			
 			break;
 
 		case _WINDOW_PRESENT_DEFAULT:
-			xcb_present_notify_msc(_x_con, w->x_win, ++w->present_serial, 0, DG_CORE_CONFIG->anim_divider, 0);
+			xcb_present_notify_msc(
+				_x_con,
+				w->x_win,
+				++w->present_serial,
+				0,
+				DG_CORE_CONFIG->anim_divider > 0 ? DG_CORE_CONFIG->anim_divider + w->divider_rise : 0,
+				0);
 			w->present_schedule = _WINDOW_PRESENT_NONE;
 			break;
 	}
@@ -4672,7 +7361,9 @@ _window_process_cell_event(dg_core_window_t *w, _area_t *a, dg_core_cell_event_t
 
 	/* send event */
 
+	pthread_mutex_lock(&a->c->mutex);
 	a->c->fn_event(a->c, cev);
+	_cell_unlock(a->c);
 
 	/* process msg */
 
@@ -4681,9 +7372,10 @@ _window_process_cell_event(dg_core_window_t *w, _area_t *a, dg_core_cell_event_t
 	}
 
 	if (cev->msg & DG_CORE_CELL_EVENT_MSG_REQUEST_UPDATE) {
+		_retain_clear(a->c);
 		_window_set_render_level(w, _WINDOW_RENDER_AREAS);
 		_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
-		a->redraw = true;
+		_area_request_redraw(a, NULL);
 	}
 
 	if (cev->msg & DG_CORE_CELL_EVENT_MSG_REQUEST_LOCK && a == w->a_focus && DG_CORE_CONFIG->cell_auto_lock) {
@@ -4699,88 +7391,300 @@ _window_process_cell_event(dg_core_window_t *w, _area_t *a, dg_core_cell_event_t
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static void
+_window_push_damage(dg_core_window_t *w, xcb_pixmap_t x_pix)
+{
+	const uint16_t pw = cairo_image_surface_get_width(w->img.c_srf);
+	const uint16_t ph = cairo_image_surface_get_height(w->img.c_srf);
+
+	cairo_rectangle_int_t r = {0, 0, pw, ph};
+
+	cairo_surface_flush(w->img.c_srf);
+
+	/* if damage tracking ran out of memory at some point, push the whole image */
+
+	if (cairo_region_status(w->img.damage) != CAIRO_STATUS_SUCCESS) {
+		cairo_region_destroy(w->img.damage);
+		w->img.damage = cairo_region_create_rectangle(&r);
+	} else {
+		cairo_region_intersect_rectangle(w->img.damage, &r);
+	}
+
+	/* only copy the rectangles drawn since the last frame, the pixmap already holds the rest */
+
+	const int n = cairo_region_num_rectangles(w->img.damage);
+
+	for (int i = 0; i < n; i++) {
+		cairo_region_get_rectangle(w->img.damage, i, &r);
+		xcb_shm_put_image(
+			_x_con,
+			x_pix,
+			w->x_gc,
+			pw, ph,
+			r.x, r.y,
+			r.width, r.height,
+			r.x, r.y,
+			_x_dph->depth,
+			XCB_IMAGE_FORMAT_Z_PIXMAP,
+			i == n - 1,
+			w->img.x_seg,
+			0);
+	}
+
+	/* requests are processed in order, so the completion event of the last push covers all of them */
+
+	if (n > 0) {
+		w->img.n_pushes++;
+	}
+
+	r = (cairo_rectangle_int_t){0, 0, 0, 0};
+	cairo_region_intersect_rectangle(w->img.damage, &r);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static void
 _window_redraw(dg_core_window_t *w)
 {
-	if (w->render_level == _WINDOW_RENDER_NONE) {
+	if (w->render_level == _WINDOW_RENDER_NONE || _frame.w == w) {
+		return;
+	}
+
+	/* pick a pixmap the X server is done with, if all are still in use, retry on the next frame */
+
+	const size_t i_back = _window_find_idle_buffer(w);
+	if (i_back == SIZE_MAX) {
+		w->present_schedule = _WINDOW_PRESENT_NONE;
+		_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
+		return;
+	}
+
+	_window_buffer_t *b = &w->bufs[i_back];
+
+	/* with the SHM backend, the image can't be drawn over until the server is done reading it, the */
+	/* redraw is then carried out once it says so                                                  */
+
+	if (w->img.n_pushes > 0) {
+		w->img.pending = true;
 		return;
 	}
 
+	/* partial renders build upon the last frame, so bring the pixmap up to date or repaint everything */
+
+	if (w->i_front == SIZE_MAX) {
+		w->render_level = _WINDOW_RENDER_FULL;
+	} else if (b->frame != w->frame) {
+		if (b->c_srf) {
+			cairo_surface_flush(b->c_srf);
+		}
+		xcb_copy_area(_x_con, w->bufs[w->i_front].x_pix, b->x_pix, w->x_gc, 0, 0, 0, 0, w->pw, w->ph);
+		if (b->c_srf) {
+			cairo_surface_mark_dirty(b->c_srf);
+		}
+	}
+
+	if (!w->img.c_srf) {
+		w->c_ctx = b->c_ctx;
+		w->c_srf = b->c_srf;
+	}
+
 	const unsigned long timestamp = dg_core_util_get_time();
 	const unsigned long delay     = timestamp - w->last_render_time;
 	const int16_t       l         = DG_CORE_CONFIG->win_thick_bd;
 
-	dg_core_color_t cl;
-	_area_t *a;
+	dg_core_color_t cl;
+
+	w->last_render_time = timestamp;
+	cairo_set_operator(w->c_ctx, CAIRO_OPERATOR_SOURCE);
+
+	/* redraw background */
+
+	if (w->render_level == _WINDOW_RENDER_FULL) {
+		_window_add_damage(w, (_rect_t){0, 0, w->pw, w->ph});
+	}
+
+	if (w->render_level == _WINDOW_RENDER_FULL && !w->p_container) {
+		cl = DG_CORE_CONFIG->win_cl_bg;
+		cairo_set_source_rgba(w->c_ctx, cl.r, cl.g, cl.b, cl.a);
+		cairo_rectangle(w->c_ctx, l, l, w->pw - 2 * l, w->ph - 2 * l);
+		cairo_fill(w->c_ctx);
+	}
+
+	/* redraw border */
+
+	if (l > 0 && w->render_level != _WINDOW_RENDER_AREAS && !w->p_container) {
+		cl = _window_get_border_color(w);
+		cairo_set_source_rgba(w->c_ctx, cl.r, cl.g, cl.b, cl.a);
+		cairo_rectangle(w->c_ctx, 0, 0, w->pw, l);
+		cairo_rectangle(w->c_ctx, 0, l, l, w->ph - 2 * l);
+		cairo_rectangle(w->c_ctx, w->pw, l, -l, w->ph - 2 * l);
+		cairo_rectangle(w->c_ctx, 0, w->ph, w->pw, -l);
+		cairo_fill(w->c_ctx);
+		_window_add_damage(w, (_rect_t){0,         0,         w->pw, l});
+		_window_add_damage(w, (_rect_t){0,         l,         l,     w->ph - 2 * l});
+		_window_add_damage(w, (_rect_t){w->pw - l, l,         l,     w->ph - 2 * l});
+		_window_add_damage(w, (_rect_t){0,         w->ph - l, w->pw, l});
+	}
+
+	/* first repaint cells with no focus at all               */
+	/* then repaint cells with secondary (touch) focus if any */
+	/* finaly, always render the primarily focused cell last  */
+
+	if (w->render_level == _WINDOW_RENDER_BORDER) {
+		goto skip_areas;
+	}
+
+	if (_render_handoff(w, i_back, delay)) {
+		return;
+	}
+
+	_window_batch_draws(w, true);
+	_window_redraw_unfocused(w, delay);
+
+	/* tiers are listed right before being drawn, to include neighbours that lower tiers drew over */
+
+	for (size_t i = 0, n = _window_list_areas(w, DG_CORE_CELL_FOCUS_SECONDARY); i < n; i++) {
+		_area_redraw(_draws[i], w, delay);
+	}
+
+	if (w->a_focus) {
+		_area_redraw(w->a_focus, w, delay);
+	}
+
+	_window_batch_draws(w, false);
+
+skip_areas:
+
+	w->present_schedule = _WINDOW_PRESENT_NONE;
+	w->render_level     = _WINDOW_RENDER_NONE;
+
+	_window_redraw_end(w, i_back, delay);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_window_redraw_end(dg_core_window_t *w, size_t i_back, unsigned long delay)
+{
+	_window_buffer_t *b = &w->bufs[i_back];
+
+	/* check if there is any requests for a new render cycle */
+
+	if (w->g_current->n_dirty > 0) {
+		_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
+		_window_set_render_level(w, _WINDOW_RENDER_AREAS);
+	}
+
+	/* run redraw callback, it may draw anywhere */
+
+	if (w->callback_redraw) {
+		_window_add_damage(w, (_rect_t){0, 0, w->pw, w->ph});
+	}
+
+	_RUN_FN(w->callback_redraw, w, delay);
+
+	/* flip the new frame in */
+
+	if (w->img.c_srf) {
+		_window_push_damage(w, b->x_pix);
+	} else {
+		cairo_surface_flush(b->c_srf);
+	}
+
+	b->frame      = ++w->frame;
+	b->idle       = false;
+	b->target_msc = w->msc_target;
+	w->i_front    = i_back;
+
+	xcb_present_pixmap(
+		_x_con,
+		w->x_win,
+		b->x_pix,
+		w->frame,
+		XCB_NONE,
+		XCB_NONE,
+		0, 0,
+		XCB_NONE,
+		XCB_NONE,
+		XCB_NONE,
+		w->low_latency ? XCB_PRESENT_OPTION_ASYNC : XCB_PRESENT_OPTION_NONE,
+		w->msc_target, 0, 0,
+		0, NULL);
+
+	/* keep track of how long frames take, growing fast and shrinking slowly to stay on the safe side */
 
-	w->last_render_time = timestamp;
-	cairo_set_operator(w->c_ctx, CAIRO_OPERATOR_SOURCE);
+	const unsigned long cost = dg_core_util_get_time() - w->last_render_time;
 
-	/* redraw background */
+	w->render_cost = cost > w->render_cost ? cost : (w->render_cost * 7 + cost) / 8;
+}
 
-	if (w->render_level == _WINDOW_RENDER_FULL && !w->p_container) {
-		cl = DG_CORE_CONFIG->win_cl_bg;
-		cairo_set_source_rgba(w->c_ctx, cl.r, cl.g, cl.b, cl.a);
-		cairo_rectangle(w->c_ctx, l, l, w->pw - 2 * l, w->ph - 2 * l);
-		cairo_fill(w->c_ctx);
-	}
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-	/* redraw border */
+static void
+_window_redraw_unfocused(dg_core_window_t *w, unsigned long delay)
+{
+	_area_t *a;
+	_area_job_t *job;
 
-	if (l > 0 && w->render_level != _WINDOW_RENDER_AREAS && !w->p_container) {
-		cl = _window_get_border_color(w);
-		cairo_set_source_rgba(w->c_ctx, cl.r, cl.g, cl.b, cl.a);
-		cairo_rectangle(w->c_ctx, 0, 0, w->pw, l);
-		cairo_rectangle(w->c_ctx, 0, l, l, w->ph - 2 * l);
-		cairo_rectangle(w->c_ctx, w->pw, l, -l, w->ph - 2 * l);
-		cairo_rectangle(w->c_ctx, 0, w->ph, w->pw, -l);
-		cairo_fill(w->c_ctx);
-	}
+	/* cells without focus can be drawn in any order, so they get spread across render threads when the */
+	/* window is drawn on a client side image. Cells that did not opt into threaded drawing, cells shown */
+	/* in several areas and retained cells are still drawn on the loop thread                            */
 
-	/* first repaint cells with no focus at all               */
-	/* then repaint cells with secondary (touch) focus if any */
-	/* finaly, always render the primarily focused cell last  */
+	const size_t n = _window_list_areas(w, DG_CORE_CELL_FOCUS_NONE);
 
-	if (w->render_level == _WINDOW_RENDER_BORDER) {
-		goto skip_areas;
-	}
+	bool parallel = cairo_surface_get_type(w->c_srf) == CAIRO_SURFACE_TYPE_IMAGE && _pool_start();
 
-	for (size_t i = 0; i < w->g_current->areas.n; i++) {
-		a = (_area_t*)w->g_current->areas.ptr[i];
-		if (_area_get_focus_type(a, w) == DG_CORE_CELL_FOCUS_NONE) {
-			_area_redraw(a, w, delay);
+	if (parallel && _pool_jobs_n_alloc < n) {
+		job = realloc(_pool_jobs, n * sizeof(_area_job_t));
+		if (job) {
+			_pool_jobs         = job;
+			_pool_jobs_n_alloc = n;
+		} else {
+			dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+			parallel = false;
 		}
 	}
 
-	for (size_t i = 0; i < w->g_current->areas.n; i++) {
-		a = (_area_t*)w->g_current->areas.ptr[i];
-		if (_area_get_focus_type(a, w) == DG_CORE_CELL_FOCUS_SECONDARY) {
+	_pool_jobs_n = 0;
+
+	for (size_t i = 0; i < n; i++) {
+		a = _draws[i];
+		if (!parallel || !a->c->threaded || a->c->areas.n > 1 || (a->c->retained && DG_CORE_CONFIG->retain_budget > 0)) {
 			_area_redraw(a, w, delay);
+		} else if (_area_redraw_prepare(a, w, delay, _pool_jobs + _pool_jobs_n)) {
+			_pool_jobs_n++;
 		}
 	}
 
-	if (w->a_focus) {
-		_area_redraw(w->a_focus, w, delay);
+	if (_pool_jobs_n == 0) {
+		return;
 	}
 
-skip_areas:
+	/* pending drawing operations of the loop thread have to land before the render threads write pixels */
 
-	/* check if there is any requests for a new render cycle */
+	_window_batch_draws(w, false);
+	cairo_surface_flush(w->c_srf);
 
-	w->present_schedule = _WINDOW_PRESENT_NONE;
-	w->render_level     = _WINDOW_RENDER_NONE;
+	_pool_run(w->c_srf);
 
-	for (size_t i = 0; i < w->g_current->areas.n; i++) {
-		if (((_area_t*)w->g_current->areas.ptr[i])->redraw) {
-			w->present_schedule = _WINDOW_PRESENT_DEFAULT;
-			w->render_level     = _WINDOW_RENDER_AREAS;
-			break;
-		}
-	}
+	cairo_surface_mark_dirty(w->c_srf);
+	_window_batch_draws(w, true);
 
-	/* run redraw callback */
+	/* cells that drew out of their bounds got cut by their clip, they're drawn again directly on the window */
+	/* in order to also get their neighbours updated. Same goes for jobs no thread could take care of. All  */
+	/* the jobs after them are drawn again as well, so that overlaps end up as if everything was serial     */
 
-	_RUN_FN(w->callback_redraw, w, delay);
+	bool redraw = false;
+
+	for (size_t i = 0; i < _pool_jobs_n; i++) {
+		job = _pool_jobs + i;
+		redraw = redraw || !job->done || (job->dc.msg & DG_CORE_CELL_DRAW_MSG_OUT_OF_BOUNDS && !job->clip);
+		if (redraw) {
+			job->dc.msg = DG_CORE_CELL_DRAW_MSG_NONE;
+			_area_redraw_draw(job->a, w, job);
+		}
+		_area_redraw_finish(job->a, w, job);
+	}
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -4825,14 +7729,66 @@ _window_refocus(dg_core_window_t *w)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static void
+_window_reset_buffers(dg_core_window_t *w)
+{
+	_window_buffer_t *b;
+
+	_render_wait();
+
+	for (size_t i = 0; i < _WINDOW_BUFFERS; i++) {
+		b = &w->bufs[i];
+		if (b->c_ctx) {
+			cairo_destroy(b->c_ctx);
+		}
+		if (b->c_srf) {
+			cairo_surface_destroy(b->c_srf);
+		}
+		if (b->x_pix) {
+			xcb_free_pixmap(_x_con, b->x_pix);
+		}
+		*b = (_window_buffer_t){.x_pix = 0, .c_srf = NULL, .c_ctx = NULL, .frame = 0, .idle = true};
+	}
+
+	if (w->img.c_ctx) {
+		cairo_destroy(w->img.c_ctx);
+	}
+	if (w->img.c_srf) {
+		cairo_surface_destroy(w->img.c_srf);
+	}
+	if (w->img.damage) {
+		cairo_region_destroy(w->img.damage);
+	}
+	if (w->img.x_seg) {
+		xcb_shm_detach(_x_con, w->img.x_seg);
+	}
+	if (w->img.data) {
+		shmdt(w->img.data);
+	}
+
+	w->img = (_window_image_t){.x_seg = 0, .data = NULL, .c_srf = NULL, .c_ctx = NULL, .damage = NULL, .n_pushes = 0, .pending = false};
+
+	w->c_ctx   = NULL;
+	w->c_srf   = NULL;
+	w->i_front = SIZE_MAX;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static void
 _window_resize(dg_core_window_t *w, int16_t pw, int16_t ph)
 {
 	w->pw = pw;
 	w->ph = ph;
 
-	cairo_surface_flush(w->c_srf);
-	cairo_xcb_surface_set_size(w->c_srf, w->pw, w->ph);
+	/* pixmaps can't be resized, so the swapchain is rebuilt and its content is repainted from scratch */
+
+	if (!_window_update_buffers(w)) {
+		dg_core_errno_set(DG_CORE_ERRNO_CAIRO);
+	}
+
+	_window_set_render_level(w, _WINDOW_RENDER_FULL);
+	_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -4845,11 +7801,15 @@ _window_seek_focus_logic(dg_core_window_t *w, _area_t *a_start, _focus_seek_para
 	size_t id_start;
 	size_t id_end;
 
+	/* areas are never pulled from a grid so their position in it follows the assignment order */
+
+	const size_t id_a = a_start ? dg_core_slotmap_locate(&w->g_current->areas, a_start->id) : 0;
+
 	if (dir > 0) {
-		id_start = a_start ? a_start->id + 1: 0;
+		id_start = a_start ? id_a + 1: 0;
 		id_end   = w->g_current->areas.n;
 	} else {
-		id_start = a_start ? a_start->id - 1: w->g_current->areas.n - 1;
+		id_start = a_start ? id_a - 1: w->g_current->areas.n - 1;
 		id_end   = SIZE_MAX;
 	}
 
@@ -5002,8 +7962,19 @@ _window_set_focus_lock(dg_core_window_t *w, bool lock)
 static void
 _window_set_present_schedule (dg_core_window_t *w, _window_present_schedule_t present_schedule)
 {
-	if (w->present_schedule != _WINDOW_PRESENT_IMMEDIATE && present_schedule != _WINDOW_PRESENT_NONE) {
-		w->present_schedule = present_schedule;
+	if (w->present_schedule == _WINDOW_PRESENT_IMMEDIATE || present_schedule == _WINDOW_PRESENT_NONE) {
+		return;
+	}
+
+	w->present_schedule = present_schedule;
+
+	/* without room to queue the window, the present is done right away rather than lost */
+
+	if (!w->present_queued) {
+		w->present_queued = dg_core_stack_append(&_windows_dirty, w, NULL);
+		if (!w->present_queued) {
+			_window_present(w);
+		}
 	}
 }
 
@@ -5049,8 +8020,22 @@ _window_set_state(dg_core_window_t *w, dg_core_window_state_t state, dg_core_win
 		return;
 	}
 
+	if ((s ^ w->state) & DG_CORE_WINDOW_STATE_ACTIVE) {
+		if (w->state & DG_CORE_WINDOW_STATE_ACTIVE) {
+			_windows_n_active++;
+		} else {
+			_windows_n_active--;
+		}
+	}
+
 	_RUN_FN(w->callback_state, w, state, mode);
 
+	/* timed updates are put on hold while nothing of the window can be seen */
+
+	if ((s ^ w->state) & (DG_CORE_WINDOW_STATE_OBSCURED | DG_CORE_WINDOW_STATE_MAPPED)) {
+		_window_wake_arm(w);
+	}
+
 	/* request repaints for state updates that change the appearance of the window's border and background */
 
 	if (DG_CORE_CONFIG->win_dynamic_bd &&
@@ -5100,6 +8085,57 @@ _window_toggle_state(dg_core_window_t *w, dg_core_window_state_t state)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static bool
+_window_update_buffers(dg_core_window_t *w)
+{
+	_window_buffer_t *b;
+
+	const uint16_t pw = w->pw > 0 ? w->pw : 1;
+	const uint16_t ph = w->ph > 0 ? w->ph : 1;
+
+	_window_reset_buffers(w);
+
+	/* the SHM backend draws into a single client side image whose changes are then pushed into the */
+	/* pixmaps, if the segment can't be shared all upcoming windows fall back to the XCB backend    */
+
+	if (_render_backend == DG_CORE_CONFIG_RENDER_SHM && !_window_update_image(w, pw, ph)) {
+		_window_reset_buffers(w);
+		_render_backend = DG_CORE_CONFIG_RENDER_XCB;
+	}
+
+	for (size_t i = 0; i < _WINDOW_BUFFERS; i++) {
+
+		b = &w->bufs[i];
+		b->x_pix = xcb_generate_id(_x_con);
+		xcb_create_pixmap(_x_con, _x_dph->depth, b->x_pix, w->x_win, pw, ph);
+
+		if (w->img.c_srf) {
+			continue;
+		}
+
+		b->c_srf = cairo_xcb_surface_create(_x_con, b->x_pix, _x_vis, pw, ph);
+		if (cairo_surface_status(b->c_srf) != CAIRO_STATUS_SUCCESS) {
+			return false;
+		}
+
+		b->c_ctx = cairo_create(b->c_srf);
+		if (cairo_status(b->c_ctx) != CAIRO_STATUS_SUCCESS) {
+			return false;
+		}
+
+		cairo_set_operator(b->c_ctx, CAIRO_OPERATOR_SOURCE);
+	}
+
+	/* until the first frame is rendered, drawing outside of redraws goes to the first pixmap */
+
+	w->c_ctx = w->img.c_srf ? w->img.c_ctx : w->bufs[0].c_ctx;
+	w->c_srf = w->img.c_srf ? w->img.c_srf : w->bufs[0].c_srf;
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static void
 _window_update_current_grid(dg_core_window_t *w)
 {
@@ -5107,6 +8143,8 @@ _window_update_current_grid(dg_core_window_t *w)
 		return;
 	}
 
+	_render_wait();
+
 	dg_core_grid_t *g_old = w->g_current;
 
 	/* first find the smallest grid, then find the biggest grid that could fit in the current */
@@ -5157,6 +8195,60 @@ _window_update_geometries(dg_core_window_t *w, bool is_popup)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static bool
+_window_update_image(dg_core_window_t *w, uint16_t pw, uint16_t ph)
+{
+	const int stride = cairo_format_stride_for_width(CAIRO_FORMAT_ARGB32, pw);
+
+	/* allocate then share the segment, it is marked for removal right away so it does not outlive */
+	/* the program, it stays valid until both sides detach from it                                */
+
+	const int shm_id = shmget(IPC_PRIVATE, (size_t)stride * ph, IPC_CREAT | 0600);
+	if (shm_id < 0) {
+		return false;
+	}
+
+	w->img.data = shmat(shm_id, NULL, 0);
+	if (w->img.data == (void*)-1) {
+		w->img.data = NULL;
+		shmctl(shm_id, IPC_RMID, NULL);
+		return false;
+	}
+
+	w->img.x_seg = xcb_generate_id(_x_con);
+	if (_x_test_cookie(xcb_shm_attach_checked(_x_con, w->img.x_seg, shm_id, 0), false)) {
+		w->img.x_seg = 0;
+	}
+
+	shmctl(shm_id, IPC_RMID, NULL);
+	if (!w->img.x_seg) {
+		return false;
+	}
+
+	/* setup cairo on top of it */
+
+	w->img.c_srf = cairo_image_surface_create_for_data(w->img.data, CAIRO_FORMAT_ARGB32, pw, ph, stride);
+	if (cairo_surface_status(w->img.c_srf) != CAIRO_STATUS_SUCCESS) {
+		return false;
+	}
+
+	w->img.c_ctx = cairo_create(w->img.c_srf);
+	if (cairo_status(w->img.c_ctx) != CAIRO_STATUS_SUCCESS) {
+		return false;
+	}
+
+	w->img.damage = cairo_region_create();
+	if (cairo_region_status(w->img.damage) != CAIRO_STATUS_SUCCESS) {
+		return false;
+	}
+
+	cairo_set_operator(w->img.c_ctx, CAIRO_OPERATOR_SOURCE);
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static void
 _window_update_wm_focus_hints(dg_core_window_t *w)
 {
@@ -5218,21 +8310,148 @@ _window_update_wm_size_hints(dg_core_window_t *w)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static xcb_atom_t
-_x_get_atom(const char *name)
+static void
+_window_wake_arm(dg_core_window_t *w)
 {
-	xcb_atom_t xa; 
+	const bool hidden = (w->state & DG_CORE_WINDOW_STATE_OBSCURED) || !(w->state & DG_CORE_WINDOW_STATE_MAPPED);
 
-	xcb_intern_atom_cookie_t xc = xcb_intern_atom(_x_con, 0, strlen(name), name);
-	xcb_intern_atom_reply_t *xr = xcb_intern_atom_reply(_x_con, xc, NULL);
-	if (!xr) {
-		dg_core_errno_set(DG_CORE_ERRNO_XCB);
-		return 0;
+	if (w->n_wakes == 0 || hidden) {
+		if (w->wake_timer) {
+			dg_core_timer_stop(w->wake_timer);
+		}
+		return;
 	}
-	
-	xa = xr->atom;
-	free(xr);
-	return xa;
+
+	if (!w->wake_timer) {
+		w->wake_timer = dg_core_timer_create(_window_wake_expire, w);
+		if (!w->wake_timer) {
+			return;
+		}
+	}
+
+	const unsigned long now = dg_core_util_get_time();
+
+	dg_core_timer_start(w->wake_timer, w->wakes[0]->wake > now ? w->wakes[0]->wake - now : 0, 0);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_window_wake_clear(dg_core_window_t *w)
+{
+	for (size_t i = 0; i < w->n_wakes; i++) {
+		w->wakes[i]->wake_w  = NULL;
+		w->wakes[i]->wake_id = SIZE_MAX;
+	}
+
+	w->n_wakes = 0;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_window_wake_expire(dg_core_timer_t *t)
+{
+	dg_core_window_t *w = (dg_core_window_t*)dg_core_timer_get_props(t);
+	_area_t *a;
+
+	const unsigned long now = dg_core_util_get_time();
+
+	/* cells sharing a deadline, like phase-aligned blinkers, all get served by the same frame */
+
+	while (w->n_wakes > 0 && w->wakes[0]->wake <= now) {
+		a = w->wakes[0];
+		_window_wake_pull(w, a);
+		if (a->g_parent != w->g_current) {
+			continue;
+		}
+		_area_request_redraw(a, a->wake_clip.w > 0 ? &a->wake_clip : NULL);
+		_window_set_render_level(w, _WINDOW_RENDER_AREAS);
+		_window_set_present_schedule(w, _WINDOW_PRESENT_DEFAULT);
+	}
+
+	_window_wake_arm(w);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_window_wake_pull(dg_core_window_t *w, _area_t *a)
+{
+	const size_t i = a->wake_id;
+
+	a->wake_w  = NULL;
+	a->wake_id = SIZE_MAX;
+
+	/* move the last area in the freed slot and restore heap order from there */
+
+	if (--w->n_wakes == i) {
+		return;
+	}
+
+	w->wakes[i] = w->wakes[w->n_wakes];
+	w->wakes[i]->wake_id = i;
+
+	_window_wake_sift(w, i);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_window_wake_push(dg_core_window_t *w, _area_t *a)
+{
+	if (w->n_wakes >= w->n_wakes_alloc) {
+		const size_t n_alloc = w->n_wakes_alloc > 0 ? w->n_wakes_alloc * 2 : 4;
+		void *tmp = realloc(w->wakes, n_alloc * sizeof(_area_t*));
+		if (!tmp) {
+			dg_core_errno_set(DG_CORE_ERRNO_MEMORY);
+			return false;
+		}
+		w->wakes = tmp;
+		w->n_wakes_alloc = n_alloc;
+	}
+
+	a->wake_w  = w;
+	a->wake_id = w->n_wakes;
+	w->wakes[w->n_wakes++] = a;
+
+	_window_wake_sift(w, a->wake_id);
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static void
+_window_wake_sift(dg_core_window_t *w, size_t i)
+{
+	_area_t *a = w->wakes[i];
+	size_t j;
+
+	/* sift up, towards earlier deadlines */
+
+	while (i > 0 && w->wakes[(j = (i - 1) / 2)]->wake > a->wake) {
+		w->wakes[i] = w->wakes[j];
+		w->wakes[i]->wake_id = i;
+		i = j;
+	}
+
+	/* sift down, towards later deadlines */
+
+	while ((j = i * 2 + 1) < w->n_wakes) {
+		if (j + 1 < w->n_wakes && w->wakes[j + 1]->wake < w->wakes[j]->wake) {
+			j++;
+		}
+		if (w->wakes[j]->wake >= a->wake) {
+			break;
+		}
+		w->wakes[i] = w->wakes[j];
+		w->wakes[i]->wake_id = i;
+		i = j;
+	}
+
+	w->wakes[i] = a;
+	a->wake_id = i;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -5271,12 +8490,41 @@ _x_get_atom_sel_target(int selection)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+static void
+_x_get_atoms(const dg_core_atom_req_t *reqs, size_t n)
+{
+	xcb_intern_atom_cookie_t xc[DG_CORE_ATOM_BATCH];
+	xcb_intern_atom_reply_t *xr;
+
+	size_t n_batch;
+
+	/* send a whole batch of intern requests before waiting on any of their replies */
+
+	for (size_t i = 0; i < n; i += n_batch) {
+		n_batch = n - i < DG_CORE_ATOM_BATCH ? n - i : DG_CORE_ATOM_BATCH;
+		for (size_t j = 0; j < n_batch; j++) {
+			xc[j] = xcb_intern_atom(_x_con, 0, strlen(reqs[i + j].name), reqs[i + j].name);
+		}
+		for (size_t j = 0; j < n_batch; j++) {
+			xr = xcb_intern_atom_reply(_x_con, xc[j], NULL);
+			if (!xr) {
+				dg_core_errno_set(DG_CORE_ERRNO_XCB);
+				*reqs[i + j].atom = 0;
+				continue;
+			}
+			*reqs[i + j].atom = xr->atom;
+			free(xr);
+		}
+	}
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 static uint8_t 
-_x_get_extension_opcode(const char *name)
+_x_get_extension_opcode(xcb_query_extension_cookie_t xc)
 {
 	uint8_t opcode;
 
-	xcb_query_extension_cookie_t xc = xcb_query_extension(_x_con, strlen(name), name);
 	xcb_query_extension_reply_t *xr = xcb_query_extension_reply(_x_con, xc, NULL);
 	if (!xr) {
 		dg_core_errno_set(DG_CORE_ERRNO_XCB);
@@ -5364,7 +8612,9 @@ _x_get_timestamp(void)
 			free(x_ev);
 			break;
 		} else {
-			dg_core_stack_push(&_events, x_ev, NULL);
+			if (!dg_core_queue_push(&_events, x_ev)) {
+				free(x_ev);
+			}
 		}
 	}
 
@@ -27,6 +27,8 @@
 #include <cairo/cairo.h>
 #include <xcb/xcb.h>
 
+#include "config.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -54,6 +56,11 @@ typedef struct _grid_t dg_core_grid_t;
  */
 typedef struct _cell_t dg_core_cell_t;
 
+/**
+ * Opaque struct representing timers run by the event loop.
+ */
+typedef struct _timer_t dg_core_timer_t;
+
 /************************************************************************************************************/
 /* MAIN *****************************************************************************************************/
 /************************************************************************************************************/
@@ -107,8 +114,46 @@ void dg_core_reset(void);
  */
 void dg_core_reconfig(void);
 
+/**
+ * Sets a callback that gets called around the drawing of cells, so that a drawing library can defer and batch
+ * its operations across all the cells of a frame. It is called with open = true before cells get drawn on a
+ * window's cairo context, then with open = false before the module draws on or clips that context itself, as
+ * well as at the end of the frame. All deferred operations have to be carried out by then. The base module
+ * sets its own callback when it is initialised.
+ * This function can be used when the module is not initialized.
+ *
+ * @param fn : function to callback, NULL to unset it
+ *
+ * @subparam fn.c_ctx : cairo context the cells draw on
+ * @subparam fn.open  : whether drawing operations can be deferred from now on or not
+ */
+void dg_core_set_callback_draw_batch(void (*fn)(cairo_t *c_ctx, bool open));
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+/**
+ * Gets the rendering backend windows are actually drawn with. It is the one requested by the
+ * "core.misc_render_backend" resource, unless MIT-SHM was requested but turned out to be unavailable, in
+ * which case windows fall back to the XCB backend. That fallback can also happen when the first window gets
+ * created, if the X server can't share memory with the program (on remote displays for instance).
+ *
+ * @return : self-explanatory
+ */
+dg_core_config_render_backend_t dg_core_get_render_backend(void);
+
+/**
+ * Gets an atom that was interned by the module during its initialisation, without any round trip to the X
+ * server. This covers all DG specific atoms (see atom.h), including the numbered accelerator ones, as well as
+ * the standard atoms the module relies on. Other modules sharing the same connection should use this instead
+ * of interning these atoms again.
+ * This function can be used when the module is not initialized.
+ *
+ * @param name : atom name
+ *
+ * @return : the atom, XCB_ATOM_NONE if it is unknown or DG has not been initialized
+ */
+xcb_atom_t dg_core_get_xcb_atom(const char *name);
+
 /**
  * Gets the xcb connection currently used by the module
  * This function can be used when the module is not initialized.
@@ -154,6 +199,27 @@ unsigned int dg_core_get_serial(void);
  */
 void dg_core_loop_abort(void);
 
+/**
+ * Watches a file descriptor from within the event loop, alongside the X connection. Each time poll() reports
+ * activity on @fd, @fn is called from the loop's thread with the returned events. Visual updates and
+ * destructions requested from the callback are handled the same way as from any other event. If @fd is
+ * already watched, its events mask and callback are replaced. The file descriptor is not owned by DG and
+ * must be removed with dg_core_loop_remove_fd() before it gets closed.
+ *
+ * @param fd     : file descriptor to watch
+ * @param events : poll() events to watch for, like POLLIN or POLLOUT
+ * @param fn     : function to call when the file descriptor is active
+ *
+ * @subparam fn.fd      : file descriptor that triggered the callback
+ * @subparam fn.revents : poll() events that occured
+ *
+ * @return : true in case of success, false otherwhise
+ *
+ * @error DG_CORE_ERRNO_MEMORY : out of memory to allocate to the watch
+ * @error DG_CORE_ERRNO_STACK  : failed to push the watch to the file descriptor tracker
+ */
+bool dg_core_loop_add_fd(int fd, short events, void (*fn)(int fd, short revents));
+
 /**
  * Allows the end-user to abort the event loop with a keybind.
  * This is the default state.
@@ -170,6 +236,14 @@ void dg_core_loop_allow_user_exit(void);
  */
 void dg_core_loop_block_user_exit(void);
 
+/**
+ * Stops watching a file descriptor previously added with dg_core_loop_add_fd(). Does nothing if @fd is not
+ * watched. Can be called from within the file descriptor's own callback.
+ *
+ * @param fd : file descriptor to stop watching
+ */
+void dg_core_loop_remove_fd(int fd);
+
 /**
  * Enter the event loop. It will run until it is aborted, the session is reseted or if there are no remaining
  * active windows. It should not be called recursively.
@@ -204,21 +278,45 @@ void dg_core_loop_set_event_preprocessor(bool (*fn)(xcb_generic_event_t *x_ev));
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 /**
- * Injects a fake event in the form of an Xmessage to force a run through the event loop. When a signal is
- * received the callback function set by dg_core_loop_set_callback_signal() is called.
+ * Posts a message to the event loop. When the message is received the callback function set by
+ * dg_core_loop_set_callback_message() is called from within the loop's thread with the same serial and data.
  * The sole reason this function exists is to give multithreaded applications an easy way of interacting with
- * DG, since DG itself is not thread safe.
- * Note that this signal does a round trip to the X server, so its effect is not instantaneous and is
- * therefore not suitable for precise time-dependent activities.
+ * DG, since DG itself is not thread safe. Unlike the rest of DG, it can safely be called from any thread, at
+ * any time between dg_core_init() and dg_core_reset().
+ * Messages go through a bounded lock-free queue that is drained by the loop, which gets woken up with an
+ * eventfd. Posting never blocks and never involves the X server. If the queue is full, the message is
+ * discarded and this function returns false. The ownership of @data is not transfered to DG.
  * Exceptionally, due to its main use-case being multi-threading, it does not set a DG error code (as the
  * functions in the errno.h header are not thread safe either).
  *
+ * @param serial : number used for message + callback pairs identification
+ * @param data   : optional, arbitrary pointer handed over to the callback
+ *
+ * @return : true in case of success, false otherwhise
+ */
+bool dg_core_loop_send_message(uint32_t serial, void *data);
+
+/**
+ * Posts a signal to the event loop. When a signal is received the callback function set by
+ * dg_core_loop_set_callback_signal() is called. This is a shorthand for messages that carry no data, it goes
+ * through the same queue and has the same properties as dg_core_loop_send_message().
+ *
  * @param serial : number used for signal + callback pairs identification
  *
  * @return : true in case of success, false otherwhise
  */
 bool dg_core_loop_send_signal(uint32_t serial);
 
+/**
+ * Callback function of dg_core_loop_send_message(). Called each time a message is received.
+ *
+ * @param fn : function to callback
+ *
+ * @subparam fn.serial : serial identifier of the received message
+ * @subparam fn.data   : data pointer given with the message
+ */
+void dg_core_loop_set_callback_message(void (*fn)(uint32_t serial, void *data));
+
 /**
  * Callback function of dg_core_loop_send_signal(). Called each time a signal is received.
  *
@@ -359,6 +457,18 @@ void dg_core_window_set_fixed_size(dg_core_window_t *w, int16_t pw, int16_t ph);
  */
 void dg_core_window_set_fixed_position(dg_core_window_t *w, int16_t px, int16_t py);
 
+/**
+ * Opts a window in or out of low latency mode. Windows normally start rendering as late as their measured
+ * frame time allows before the next vertical blank, and present their frames on it. A low latency window
+ * instead renders as soon as it's notified and flips its frames in right away, even in the middle of a
+ * scanout. This trades tearing for up to a frame less of input lag, which suits games and the like. Windows
+ * are not in low latency mode by default.
+ *
+ * @param w           : target window
+ * @param low_latency : self-explanatory
+ */
+void dg_core_window_set_low_latency(dg_core_window_t *w, bool low_latency);
+
 /**
  * Marks a window as enabled, and allow user input (default state).
  *
@@ -609,7 +719,10 @@ void dg_core_window_set_callback_redraw(dg_core_window_t *w, void (*fn)(dg_core_
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 /**
- * Gets the window's cairo context for drawing.
+ * Gets the window's cairo context for drawing. Windows render into a swapchain of Present pixmaps, so the
+ * context targets the pixmap of the frame being rendered (or the last one outside of a redraw) and changes
+ * from one frame to the next. Drawings only become visible with the next presented frame, and should
+ * therefore be done from a redraw callback.
  *
  * @param w : target window
  *
@@ -618,7 +731,7 @@ void dg_core_window_set_callback_redraw(dg_core_window_t *w, void (*fn)(dg_core_
 cairo_t *dg_core_window_get_cairo_context(dg_core_window_t *w);
 
 /**
- * Gets the window's cairo surface for drawing.
+ * Gets the window's cairo surface for drawing. Like the context, it belongs to the current frame's pixmap.
  *
  * @param w : target window
  *
@@ -635,6 +748,17 @@ cairo_surface_t *dg_core_window_get_cairo_surface(dg_core_window_t *w);
  */
 dg_core_grid_t *dg_core_window_get_current_grid(dg_core_window_t *w);
 
+/**
+ * Gets the number of frames the window presented after the vertical blank they were rendered for. Each miss
+ * also temporarily raises the window's framerate divider, see the "core.misc_animation_framerate_divider"
+ * resource, until enough frames are shown on time again. Low latency and unsynced frames are not counted.
+ *
+ * @param w : target window
+ *
+ * @return : self-explanatory
+ */
+unsigned long dg_core_window_get_missed_frames(dg_core_window_t *w);
+
 /**
  * Return the current height of the given window in pixels
  *
@@ -899,9 +1023,11 @@ typedef enum {
  * Return messages in response to cell drawing requests.
  */
 typedef enum {
-	DG_CORE_CELL_DRAW_MSG_NONE           = 0,
-	DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE = 1U << 0,
-	DG_CORE_CELL_DRAW_MSG_OUT_OF_BOUNDS  = 1U << 1,
+	DG_CORE_CELL_DRAW_MSG_NONE                  = 0,
+	DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE        = 1U << 0,
+	DG_CORE_CELL_DRAW_MSG_OUT_OF_BOUNDS         = 1U << 1,
+	DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE_REGION = 1U << 2,
+	DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE_AT     = 1U << 3,
 } dg_core_cell_draw_msg_t;
 
 /**
@@ -961,6 +1087,18 @@ typedef enum {
 /**
  * This struct provides all the necessary data for cells to draw themselves.
  * The msg field is intended to be modified by the cell drawing function as a response to the drawing request.
+ * If only part of the cell was requested to be redrawn (see dg_core_cell_redraw_region()), the cairo context
+ * is clipped to that part, which cells can query with cairo_clip_extents() to skip needless work.
+ * Cells setting DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE_REGION should also fill the update_* fields, in which
+ * case only that sub-rectangle will be redrawn on the next frame. DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE takes
+ * precedence over it.
+ * Cells that only change at given times, like blinkers, should rather set
+ * DG_CORE_CELL_DRAW_MSG_REQUEST_UPDATE_AT and fill update_time, so that windows sleep until then instead of
+ * redrawing on every frame. The update_* fields then restrict that update to a sub-rectangle if their width
+ * and height are above 0. Cells sharing a cadence should align their deadlines on multiples of its period, so
+ * that a single frame serves all of them. Deadlines are held while the window is obscured or unmapped, and
+ * are dropped if the cell is drawn again before, the latest drawing's message being the one that counts. Both
+ * other update requests take precedence.
  *
  * @param msg            : to be modified by the cell event handler, is used as return value by the caller
  * @param focus          : cell's focus level at the time of drawing
@@ -972,6 +1110,11 @@ typedef enum {
  * @param is_enabled     : cell state
  * @param win_is_enabled : window enable state
  * @param c_ctx          : cairo context to draw on
+ * @param update_px      : to be modified by the cell, x pixel position relative to the cell of the next update
+ * @param update_py      : to be modified by the cell, y pixel position relative to the cell of the next update
+ * @param update_pw      : to be modified by the cell, pixel width  of the next update
+ * @param update_ph      : to be modified by the cell, pixel height of the next update
+ * @param update_time    : to be modified by the cell, time of the next update, see dg_core_util_get_time()
  */
 typedef struct {
 	dg_core_cell_draw_msg_t msg;
@@ -984,6 +1127,11 @@ typedef struct {
 	bool is_enabled;
 	bool win_is_enabled;
 	cairo_t *c_ctx;	
+	int16_t update_px;
+	int16_t update_py;
+	int16_t update_pw;
+	int16_t update_ph;
+	unsigned long update_time;
 } dg_core_cell_drawing_context_t;
 
 /**
@@ -1146,7 +1294,8 @@ typedef struct {
  * Creates a custom cell and sets it different handlers.
  *
  * @param serial     : abitrary number to be used for cell identification
- * @param fn_draw    : function that draws the cell
+ * @param fn_draw    : function that draws the cell. If the core's config sets more than one render thread, it
+ *                     may be called from a worker thread concurrently with other cells' drawing functions
  * @parma fn_event   : optional, function that process incoming events, if none is supplied, the cell is
  *                     considered to be passive and cannot be focused by the end user
  * @param fn_destroy : optional, function that is called when a cell is destroyed, usually needed to cleanup
@@ -1198,6 +1347,15 @@ void dg_core_cell_disable(dg_core_cell_t *c);
  */
 void dg_core_cell_enable(dg_core_cell_t *c);
 
+/**
+ * Locks a cell's state against concurrent drawing. The lock is recursive and already held by the core while
+ * the cell's event handler runs or while it is drawn, so this is only needed to modify a threaded cell from
+ * anywhere else, see dg_core_cell_set_threaded(). Must be paired with dg_core_cell_unlock().
+ *
+ * @param c : target cell
+ */
+void dg_core_cell_lock(dg_core_cell_t *c);
+
 /**
  * Schedules a cell to be redrawn for the next frame. Applies for every areas that hold the given cell on all
  * active and visible windows current grids.
@@ -1207,6 +1365,46 @@ void dg_core_cell_enable(dg_core_cell_t *c);
  */
 void dg_core_cell_redraw(dg_core_cell_t *c);
 
+/**
+ * Schedules a sub-rectangle of a cell to be redrawn for the next frame, see dg_core_cell_redraw(). During that
+ * redraw, the cell's cairo context will be clipped to the requested rectangle, or to the bounding box of all
+ * rectangles requested since the last frame. A request for the whole cell overrides it.
+ * Does nothing if the rectangle is empty.
+ *
+ * @param c  : target cell
+ * @param px : x pixel position of the rectangle, relative to the cell
+ * @param py : y pixel position of the rectangle, relative to the cell
+ * @param pw : pixel width  of the rectangle
+ * @param ph : pixel height of the rectangle
+ */
+void dg_core_cell_redraw_region(dg_core_cell_t *c, int16_t px, int16_t py, int16_t pw, int16_t ph);
+
+/**
+ * Opts a cell in or out of retained mode. A retained cell's renderings are kept in offscreen surfaces, one
+ * per combination of size, focus type, cell and window enabled states, which are shared by all areas holding
+ * the cell. Full window redraws then copy these surfaces instead of calling the cell's drawing function.
+ * This only suits cells whose drawing depends on nothing else than their properties and the drawing context,
+ * and which request a redraw with dg_core_cell_redraw() whenever their properties change, since that discards
+ * the renderings. Cells asking for updates or drawing out of bounds are not retained in these states.
+ * The cache is capped by the "core.misc_retained_cache_budget" resource. Cells are not retained by default.
+ *
+ * @param c        : target cell
+ * @param retained : self-explanatory
+ */
+void dg_core_cell_set_retained(dg_core_cell_t *c, bool retained);
+
+/**
+ * Opts a cell in or out of threaded drawing. When the "core.misc_enable_render_thread" resource is set, frames
+ * made only of threaded cells are drawn on a dedicated thread while the event loop keeps running. The drawing
+ * function of a threaded cell may thus run concurrently with the rest of the program : the cell's state must
+ * only be modified from its event handler or between dg_core_cell_lock() and dg_core_cell_unlock() calls.
+ * Cells are not threaded by default.
+ *
+ * @param c        : target cell
+ * @param threaded : self-explanatory
+ */
+void dg_core_cell_set_threaded(dg_core_cell_t *c, bool threaded);
+
 /**
  * Enables or disables a cell. See dg_core_cell_enable() and dg_core_cell_disable().
  *
@@ -1214,6 +1412,13 @@ void dg_core_cell_redraw(dg_core_cell_t *c);
  */
 void dg_core_cell_toggle(dg_core_cell_t *c);
 
+/**
+ * Releases a lock taken with dg_core_cell_lock().
+ *
+ * @param c : target cell
+ */
+void dg_core_cell_unlock(dg_core_cell_t *c);
+
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
 /**
@@ -1391,6 +1596,84 @@ void dg_core_popup_kill_children(dg_core_window_t *w);
  */
 void dg_core_popup_kill_all(void);
 
+/************************************************************************************************************/
+/* TIMER ****************************************************************************************************/
+/************************************************************************************************************/
+
+/**
+ * Creates a stopped timer. Once started with dg_core_timer_start(), its callback is called from within the
+ * event loop's thread, so, unlike dg_core_loop_send_signal(), it can safely interact with any DG component.
+ * All timers share a single timerfd that is armed on the earliest deadline, so the event loop sleeps exactly
+ * until the next timer is due.
+ *
+ * @param fn    : function to call each time the timer expires
+ * @param props : optional, pointer to an arbitrary chunk of memory, usually used to give a context to @fn
+ *
+ * @subparam fn.t : timer that expired
+ *
+ * @return : created timer, NULL in case of failure
+ *
+ * @error DG_CORE_ERRNO_MEMORY     : out of memory to allocate to the timer
+ * @error DG_CORE_ERRNO_STACK      : failed to push the new timer to the timer tracker
+ * @error DG_CORE_ERRNO_DEPENDENCY : failed to create the timerfd backing all timers
+ */
+dg_core_timer_t *dg_core_timer_create(void (*fn)(dg_core_timer_t *t), void *props);
+
+/**
+ * Stops and destroys a timer. Can be called from within the timer's own callback.
+ *
+ * @param t : timer to destroy
+ *
+ * @error DG_CORE_ERRNO_STACK : failed to pull the timer from the timer tracker
+ */
+void dg_core_timer_destroy(dg_core_timer_t *t);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Gets the timer's props that was given to it during creation.
+ *
+ * @param t : timer to get the props from
+ *
+ * @return : self-explanatory
+ */
+const void *dg_core_timer_get_props(dg_core_timer_t *t);
+
+/**
+ * Checks if a timer has been started and has not expired or been stopped yet. Periodic timers are always
+ * running once started, until they are stopped.
+ *
+ * @param t : timer to check
+ *
+ * @return : self-explanatory
+ */
+bool dg_core_timer_is_running(dg_core_timer_t *t);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * (Re)starts a timer. If it was already running, its previous deadline is discarded. Periodic timers are
+ * rescheduled relative to their previous deadline, not to the end of their callback, so they do not drift.
+ * If the loop falls behind, missed expirations are merged into a single callback.
+ *
+ * @param t      : timer to start
+ * @param delay  : time in microseconds before the first expiration
+ * @param period : time in microseconds between subsequent expirations, 0 for a one-shot timer
+ *
+ * @return : true in case of success, false otherwhise
+ *
+ * @error DG_CORE_ERRNO_MEMORY : out of memory to grow the deadline heap
+ */
+bool dg_core_timer_start(dg_core_timer_t *t, unsigned long delay, unsigned long period);
+
+/**
+ * Stops a timer. Its callback will not be called until it is started again. If the timer is not running,
+ * this function has no effect.
+ *
+ * @param t : timer to stop
+ */
+void dg_core_timer_stop(dg_core_timer_t *t);
+
 /************************************************************************************************************/
 /************************************************************************************************************/
 /************************************************************************************************************/
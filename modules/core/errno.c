@@ -18,6 +18,8 @@
 /************************************************************************************************************/
 /************************************************************************************************************/
 
+#include <stdatomic.h>
+
 #include "errno.h"
 #include "util.h"
 
@@ -25,11 +27,11 @@
 /************************************************************************************************************/
 /************************************************************************************************************/
 
-/* persistent data */
+/* persistent data, errors can be raised by render threads too */
 
-static dg_core_errno_t _last_err = DG_CORE_ERRNO_NONE;
+static _Atomic dg_core_errno_t _last_err = DG_CORE_ERRNO_NONE;
 
-static unsigned int _n_err = 0;
+static atomic_uint _n_err = 0;
 
 static void (*_callback)(dg_core_errno_t err) = NULL;
 
@@ -47,6 +49,8 @@ static const dg_core_util_dict_t _err_str[] = {
 	{ "xcb operation(s) failed",             DG_CORE_ERRNO_XCB        },
 	{ "critical xcb operation(s) failed",    DG_CORE_ERRNO_XCB_CRIT   },
 	{ "dependency requirements are not met", DG_CORE_ERRNO_DEPENDENCY },
+	{ "memory allocation on queue failed",   DG_CORE_ERRNO_QUEUE      },
+	{ "memory allocation on slotmap failed", DG_CORE_ERRNO_SLOTMAP    },
 };
 
 /************************************************************************************************************/
@@ -56,11 +60,7 @@ static const dg_core_util_dict_t _err_str[] = {
 dg_core_errno_t
 dg_core_errno_get(void)
 {
-	const dg_core_errno_t err = _last_err;
-
-	_last_err = DG_CORE_ERRNO_NONE;
-
-	return err;
+	return atomic_exchange(&_last_err, DG_CORE_ERRNO_NONE);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -42,6 +42,8 @@ typedef enum {
 	DG_CORE_ERRNO_XCB,
 	DG_CORE_ERRNO_XCB_CRIT,
 	DG_CORE_ERRNO_DEPENDENCY,
+	DG_CORE_ERRNO_QUEUE,
+	DG_CORE_ERRNO_SLOTMAP,
 } dg_core_errno_t;
 
 /************************************************************************************************************/
@@ -92,7 +94,7 @@ const char *dg_core_errno_to_str(dg_core_errno_t err);
 
 /**
  * Set a callback function that gets executed when an error is set with dg_core_errno_set().
- * Call with fn = NULL to unset the callback.
+ * Call with fn = NULL to unset the callback. With multiple render threads, it may be called from any of them.
  *
  * @param fn : function to set as callback
  *
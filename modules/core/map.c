@@ -0,0 +1,210 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "errno.h"
+#include "map.h"
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+static bool                _extend    (dg_core_map_t *map, uint32_t n_alloc);
+static dg_core_map_slot_t *_find_slot (dg_core_map_t *map, uint32_t key);
+static uint32_t            _hash      (dg_core_map_t *map, uint32_t key);
+
+/************************************************************************************************************/
+/* PUBLIC ***************************************************************************************************/
+/************************************************************************************************************/
+
+const void *
+dg_core_map_get(dg_core_map_t *map, uint32_t key)
+{
+	assert(map);
+
+	if (map->n == 0) {
+		return NULL;
+	}
+
+	return _find_slot(map, key)->val;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+bool
+dg_core_map_init(dg_core_map_t *map, uint32_t n)
+{
+	assert(map);
+
+	*map = DG_CORE_MAP_EMPTY;
+
+	if (n == 0) {
+		return true;
+	}
+
+	uint32_t n_alloc = 8;
+
+	while (n_alloc < n * 2) {
+		n_alloc *= 2;
+	}
+
+	return _extend(map, n_alloc);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_core_map_reset(dg_core_map_t *map)
+{
+	assert(map);
+
+	free(map->slots);
+
+	*map = DG_CORE_MAP_EMPTY;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+bool
+dg_core_map_set(dg_core_map_t *map, uint32_t key, const void *val)
+{
+	assert(map);
+	assert(val);
+
+	if ((map->n + 1) * 2 > map->n_alloc && !_extend(map, map->n_alloc > 0 ? map->n_alloc * 2 : 8)) {
+		return false;
+	}
+
+	dg_core_map_slot_t *slot = _find_slot(map, key);
+
+	if (!slot->val) {
+		map->n++;
+	}
+
+	slot->key = key;
+	slot->val = val;
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_core_map_unset(dg_core_map_t *map, uint32_t key)
+{
+	assert(map);
+
+	if (map->n == 0) {
+		return;
+	}
+
+	const uint32_t mask = map->n_alloc - 1;
+
+	dg_core_map_slot_t *slot = _find_slot(map, key);
+	if (!slot->val) {
+		return;
+	}
+
+	/* backward shift deletion, move back any following slot whose ideal position is at or before the hole */
+
+	uint32_t i = slot - map->slots;
+	uint32_t j = i;
+	uint32_t k;
+
+	for (;;) {
+		j = (j + 1) & mask;
+		if (!map->slots[j].val) {
+			break;
+		}
+		k = _hash(map, map->slots[j].key);
+		if (((j - k) & mask) >= ((j - i) & mask)) {
+			map->slots[i] = map->slots[j];
+			i = j;
+		}
+	}
+
+	map->slots[i].val = NULL;
+	map->n--;
+}
+
+/************************************************************************************************************/
+/* _ ********************************************************************************************************/
+/************************************************************************************************************/
+
+static bool
+_extend(dg_core_map_t *map, uint32_t n_alloc)
+{
+	dg_core_map_t map_new = {.n = 0, .n_alloc = n_alloc};
+
+	map_new.slots = calloc(n_alloc, sizeof(dg_core_map_slot_t));
+	if (!map_new.slots) {
+		dg_core_errno_set(DG_CORE_ERRNO_HASHTABLE);
+		return false;
+	}
+
+	/* rehash */
+
+	dg_core_map_slot_t *slot;
+
+	for (uint32_t i = 0; i < map->n_alloc; i++) {
+		if (map->slots[i].val) {
+			slot = _find_slot(&map_new, map->slots[i].key);
+			*slot = map->slots[i];
+			map_new.n++;
+		}
+	}
+
+	free(map->slots);
+	*map = map_new;
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static dg_core_map_slot_t *
+_find_slot(dg_core_map_t *map, uint32_t key)
+{
+	const uint32_t mask = map->n_alloc - 1;
+
+	uint32_t i = _hash(map, key);
+
+	while (map->slots[i].val && map->slots[i].key != key) {
+		i = (i + 1) & mask;
+	}
+
+	return &map->slots[i];
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static uint32_t
+_hash(dg_core_map_t *map, uint32_t key)
+{
+	/* Fibonacci hashing, the high bits of the product are folded down because they are the best mixed */
+
+	uint32_t h = key * 2654435769u;
+
+	return (h ^ (h >> 16)) & (map->n_alloc - 1);
+}
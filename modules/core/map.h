@@ -0,0 +1,133 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#ifndef DG_CORE_MAP_H
+#define DG_CORE_MAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#define DG_CORE_MAP_EMPTY (dg_core_map_t){.slots = NULL, .n = 0, .n_alloc = 0}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Slot in the map.
+ *
+ * @param key : integer key of the slot
+ * @param val : value of the slot, NULL if the slot is free
+ */
+typedef struct {
+	uint32_t key;
+	const void *val;
+} dg_core_map_slot_t;
+
+/**
+ * Map from 32-bit integer keys, like X resource ids, to arbitrary non-NULL pointers. Slots are held in an
+ * open-addressing array with a power of 2 size, keys are hashed with a multiplicative (Fibonacci) hash and
+ * collisions are handled using linear probing. Removals shift the following slots back instead of leaving
+ * tombstones, so lookups never degrade over time. The map's size is doubled everytime it reaches a load
+ * factor of 50%. n < n_alloc.
+ *
+ * @param slots   : slot array
+ * @param n       : number of occupied slots
+ * @param n_alloc : total number of allocated slots
+ */
+typedef struct {
+	dg_core_map_slot_t *slots;
+	uint32_t n;
+	uint32_t n_alloc;
+} dg_core_map_t;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Preallocate memory to the map and set its variables appropriately. This function is recommended but
+ * optional to operate dg_core_map_t structs because a map can allocate memory automatically when needed.
+ * The actual amount of slots allocated is the smallest power of 2 that can hold n values under the load
+ * factor. If n = 0, no memory is allocated and *map is instead set to DG_CORE_MAP_EMPTY.
+ *
+ * @param map : map to init
+ * @param n   : initial desired size
+ *
+ * @return true if init was successfull, false otherwhise (errno is set)
+ *
+ * @error DG_CORE_ERRNO_HASHTABLE : memory allocation failed
+ */
+bool dg_core_map_init(dg_core_map_t *map, uint32_t n);
+
+/**
+ * Resets a given map and free memory. The values the map pointed to are not freed.
+ *
+ * @param map : map to reset
+ */
+void dg_core_map_reset(dg_core_map_t *map);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Searches for the value associated to a key.
+ *
+ * @param map : map to search
+ * @param key : key to match
+ *
+ * @return : associated value, NULL if there is none
+ */
+const void *dg_core_map_get(dg_core_map_t *map, uint32_t key);
+
+/**
+ * Associates a value to a key. If the key was already in use, its value is replaced.
+ *
+ * @param map : map to update
+ * @param key : key to set
+ * @param val : value to associate to the key, it should not be NULL
+ *
+ * @return : true in case of success, false otherwhise (errno is set)
+ *
+ * @error DG_CORE_ERRNO_HASHTABLE : memory allocation failed
+ */
+bool dg_core_map_set(dg_core_map_t *map, uint32_t key, const void *val);
+
+/**
+ * Removes a key and its associated value from the map. If the key was not in use, nothing happens.
+ *
+ * @param map : map to update
+ * @param key : key to remove
+ */
+void dg_core_map_unset(dg_core_map_t *map, uint32_t key);
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DG_CORE_MAP_H */
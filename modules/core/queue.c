@@ -0,0 +1,149 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "errno.h"
+#include "queue.h"
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+static bool _extend(dg_core_queue_t *que);
+
+/************************************************************************************************************/
+/* PUBLIC ***************************************************************************************************/
+/************************************************************************************************************/
+
+bool
+dg_core_queue_init(dg_core_queue_t *que, size_t n_alloc)
+{
+	assert(que);
+
+	if (n_alloc == 0) {
+		*que = DG_CORE_QUEUE_EMPTY;
+		return true;
+	}
+
+	que->ptr = malloc(n_alloc * sizeof(void*));
+	if (!que->ptr) {
+		dg_core_errno_set(DG_CORE_ERRNO_QUEUE);
+		return false;
+	}
+
+	que->n_alloc = n_alloc;
+	que->n = 0;
+	que->i_head = 0;
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+const void *
+dg_core_queue_peek(dg_core_queue_t *que)
+{
+	assert(que);
+
+	return que->n > 0 ? que->ptr[que->i_head] : NULL;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+const void *
+dg_core_queue_pop(dg_core_queue_t *que)
+{
+	assert(que);
+
+	if (que->n == 0) {
+		return NULL;
+	}
+
+	const void *ptr = que->ptr[que->i_head];
+
+	que->i_head = que->i_head + 1 < que->n_alloc ? que->i_head + 1 : 0;
+	que->n--;
+
+	return ptr;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+bool
+dg_core_queue_push(dg_core_queue_t *que, const void *ptr)
+{
+	assert(que);
+
+	if (que->n >= que->n_alloc && !_extend(que)) {
+		return false;
+	}
+
+	size_t i = que->i_head + que->n;
+
+	que->ptr[i < que->n_alloc ? i : i - que->n_alloc] = ptr;
+	que->n++;
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_core_queue_reset(dg_core_queue_t *que)
+{
+	assert(que);
+
+	free(que->ptr);
+
+	*que = DG_CORE_QUEUE_EMPTY;
+}
+
+/************************************************************************************************************/
+/* _ ********************************************************************************************************/
+/************************************************************************************************************/
+
+static bool
+_extend(dg_core_queue_t *que)
+{
+	const size_t n_alloc = que->n_alloc > 0 ? que->n_alloc * 2 : 8;
+
+	void *tmp = realloc(que->ptr, n_alloc * sizeof(void*));
+	if (!tmp) {
+		dg_core_errno_set(DG_CORE_ERRNO_QUEUE);
+		return false;
+	}
+
+	que->ptr = tmp;
+
+	/* only called when the queue is full, so the pointers that wrapped around the end of the old array */
+	/* are the first i_head ones, move them right after the old end to keep the queue contiguous        */
+
+	for (size_t i = 0; i < que->i_head; i++) {
+		que->ptr[que->n_alloc + i] = que->ptr[i];
+	}
+
+	que->n_alloc = n_alloc;
+
+	return true;
+}
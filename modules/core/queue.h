@@ -0,0 +1,122 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#ifndef DG_CORE_QUEUE_H
+#define DG_CORE_QUEUE_H
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#define DG_CORE_QUEUE_EMPTY (dg_core_queue_t){.ptr = NULL, .n = 0, .n_alloc = 0, .i_head = 0}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * First-in first-out queue of arbitrary pointers, backed by a growable ring buffer. Unlike dg_core_stack_t,
+ * it does not reject duplicates and both push and pop operations are done in constant time. n <= n_alloc.
+ *
+ * @param ptr     : ring array of stored pointers
+ * @param n       : number of queued pointers
+ * @param n_alloc : size of allocated array space
+ * @param i_head  : position in the array of the oldest queued pointer
+ */
+typedef struct {
+	const void **ptr;
+	size_t n;
+	size_t n_alloc;
+	size_t i_head;
+} dg_core_queue_t;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Preallocate memory to the queue and set its variables appropriately. Allocated memory in the array is not
+ * initialised. This function is recommended but optional to operate dg_core_queue_t structs because a queue
+ * can allocate memory automatically when needed.
+ * If n = 0, no memory is allocated and *que is instead set to DG_CORE_QUEUE_EMPTY.
+ *
+ * @param que     : queue to init
+ * @param n_alloc : initial allocated size of the pointer array
+ *
+ * @error DG_CORE_ERRNO_QUEUE : failure to alloc memory to the pointer array
+ */
+bool dg_core_queue_init(dg_core_queue_t *que, size_t n_alloc);
+
+/**
+ * Zeroes the queue and free allocated memory within the structure. The given structure itself is not freed,
+ * and may require an explicit free operation. The pointers that were referenced in **ptr are not freed
+ * either.
+ *
+ * @param que : queue to reset
+ */
+void dg_core_queue_reset(dg_core_queue_t *que);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Gets the oldest pointer of the queue without removing it.
+ *
+ * @param que : queue to peek into
+ *
+ * @return : oldest queued pointer, NULL if the queue is empty
+ */
+const void *dg_core_queue_peek(dg_core_queue_t *que);
+
+/**
+ * Removes the oldest pointer from the queue and returns it. The value pointed to by the removed pointer is not
+ * freed nor modified. The allocated memory is kept, so that a queue that is repeatedly filled and drained
+ * does not need to realloc.
+ *
+ * @param que : queue to remove the pointer from
+ *
+ * @return : oldest queued pointer, NULL if the queue is empty
+ */
+const void *dg_core_queue_pop(dg_core_queue_t *que);
+
+/**
+ * Adds a pointer at the end of the queue. The queue automatically expands as needed to accomodate new
+ * pointers, in which case the queued pointers are kept in order.
+ *
+ * @param que : queue to add the pointer to
+ * @param ptr : pointer to push to the queue
+ *
+ * @return : true if the pointer was successfully added, false in case of failure (and errno is also set)
+ *
+ * @error DG_CORE_ERRNO_QUEUE : failure to realloc memory to the pointer array
+ */
+bool dg_core_queue_push(dg_core_queue_t *que, const void *ptr);
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DG_CORE_QUEUE_H */
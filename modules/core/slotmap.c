@@ -0,0 +1,207 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "errno.h"
+#include "slotmap.h"
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+static bool _extend (dg_core_slotmap_t *sm, size_t n_alloc);
+static bool _is_ok  (dg_core_slotmap_t *sm, dg_core_slotmap_id_t id);
+
+/************************************************************************************************************/
+/* PUBLIC ***************************************************************************************************/
+/************************************************************************************************************/
+
+bool
+dg_core_slotmap_find(dg_core_slotmap_t *sm, const void *ptr, dg_core_slotmap_id_t id)
+{
+	assert(sm);
+
+	return _is_ok(sm, id) && sm->ptr[sm->slots[id.i].i_ptr] == ptr;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+const void *
+dg_core_slotmap_get(dg_core_slotmap_t *sm, dg_core_slotmap_id_t id)
+{
+	assert(sm);
+
+	return _is_ok(sm, id) ? sm->ptr[sm->slots[id.i].i_ptr] : NULL;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+bool
+dg_core_slotmap_init(dg_core_slotmap_t *sm, size_t n_alloc)
+{
+	assert(sm);
+
+	*sm = DG_CORE_SLOTMAP_EMPTY;
+
+	if (n_alloc == 0) {
+		return true;
+	}
+
+	return _extend(sm, n_alloc);
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+size_t
+dg_core_slotmap_locate(dg_core_slotmap_t *sm, dg_core_slotmap_id_t id)
+{
+	assert(sm);
+
+	return _is_ok(sm, id) ? sm->slots[id.i].i_ptr : SIZE_MAX;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_core_slotmap_pull(dg_core_slotmap_t *sm, dg_core_slotmap_id_t id)
+{
+	assert(sm);
+
+	if (!_is_ok(sm, id)) {
+		return;
+	}
+
+	/* fill the hole with the last pointer */
+
+	const size_t i_ptr  = sm->slots[id.i].i_ptr;
+	const size_t i_last = sm->n - 1;
+
+	sm->ptr[i_ptr]    = sm->ptr[i_last];
+	sm->i_slot[i_ptr] = sm->i_slot[i_last];
+	sm->slots[sm->i_slot[i_ptr]].i_ptr = i_ptr;
+	sm->n--;
+
+	/* invalidate the handle and chain the slot to the free ones */
+
+	sm->slots[id.i].gen++;
+	sm->slots[id.i].i_ptr = sm->i_free;
+	sm->i_free = id.i;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+bool
+dg_core_slotmap_push(dg_core_slotmap_t *sm, const void *ptr, dg_core_slotmap_id_t *id)
+{
+	assert(sm);
+	assert(id);
+
+	if (sm->n >= sm->n_alloc && !_extend(sm, sm->n_alloc > 0 ? sm->n_alloc * 2 : 8)) {
+		return false;
+	}
+
+	/* reuse a free slot if there is one, otherwhise all slots are in use so n == n_slots < n_alloc */
+
+	size_t i;
+
+	if (sm->i_free != SIZE_MAX) {
+		i = sm->i_free;
+		sm->i_free = sm->slots[i].i_ptr;
+	} else {
+		i = sm->n_slots++;
+		sm->slots[i].gen = 0;
+	}
+
+	sm->slots[i].i_ptr = sm->n;
+	sm->ptr[sm->n]     = ptr;
+	sm->i_slot[sm->n]  = i;
+	sm->n++;
+
+	id->i   = i;
+	id->gen = sm->slots[i].gen;
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+void
+dg_core_slotmap_reset(dg_core_slotmap_t *sm)
+{
+	assert(sm);
+
+	free(sm->ptr);
+	free(sm->i_slot);
+	free(sm->slots);
+
+	*sm = DG_CORE_SLOTMAP_EMPTY;
+}
+
+/************************************************************************************************************/
+/* _ ********************************************************************************************************/
+/************************************************************************************************************/
+
+static bool
+_extend(dg_core_slotmap_t *sm, size_t n_alloc)
+{
+	void *tmp;
+
+	tmp = realloc(sm->ptr, n_alloc * sizeof(void*));
+	if (!tmp) {
+		goto fail;
+	}
+
+	sm->ptr = tmp;
+
+	tmp = realloc(sm->i_slot, n_alloc * sizeof(size_t));
+	if (!tmp) {
+		goto fail;
+	}
+
+	sm->i_slot = tmp;
+
+	tmp = realloc(sm->slots, n_alloc * sizeof(dg_core_slotmap_slot_t));
+	if (!tmp) {
+		goto fail;
+	}
+
+	sm->slots   = tmp;
+	sm->n_alloc = n_alloc;
+
+	return true;
+
+	/* errors */
+
+fail:
+	dg_core_errno_set(DG_CORE_ERRNO_SLOTMAP);
+	return false;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+static bool
+_is_ok(dg_core_slotmap_t *sm, dg_core_slotmap_id_t id)
+{
+	return id.i < sm->n_slots && sm->slots[id.i].gen == id.gen && sm->slots[id.i].i_ptr < sm->n;
+}
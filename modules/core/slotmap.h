@@ -0,0 +1,187 @@
+/**
+ * Copyright © 2024 Fraawlen <fraawlen@posteo.net>
+ *
+ * This file is part of the Derelict Graphics (DG) GUI library.
+ *
+ * This library is free software; you can redistribute it and/or modify it either under the terms of the GNU
+ * Lesser General Public License as published by the Free Software Foundation; either version 2.1 of the
+ * License or (at your option) any later version.
+ *
+ * This software is distributed on an "AS IS" basis, WITHOUT WARRANTY OF ANY KIND, either express or implied.
+ * See the LGPL for the specific language governing rights and limitations.
+ *
+ * You should have received a copy of the GNU Lesser General Public License along with this program. If not,
+ * see <http://www.gnu.org/licenses/>.
+ */
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#ifndef DG_CORE_SLOTMAP_H
+#define DG_CORE_SLOTMAP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#define DG_CORE_SLOTMAP_EMPTY \
+	(dg_core_slotmap_t){ \
+		.ptr     = NULL, \
+		.i_slot  = NULL, \
+		.slots   = NULL, \
+		.n       = 0, \
+		.n_alloc = 0, \
+		.n_slots = 0, \
+		.i_free  = SIZE_MAX}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Handle to a pointer stored in a slotmap. It stays valid until the pointer is pulled from the map, after
+ * which it is recognized as stale even if its slot gets reused by another pointer.
+ *
+ * @param i   : index of the slot
+ * @param gen : generation of the slot when the handle was issued
+ */
+typedef struct {
+	size_t i;
+	uint32_t gen;
+} dg_core_slotmap_id_t;
+
+/**
+ * Slot of a slotmap.
+ *
+ * @param i_ptr : if the slot is used, position of its pointer in the slotmap's ptr array, otherwhise index of
+ *                the next free slot, SIZE_MAX if there is none
+ * @param gen   : generation of the slot, incremented everytime its pointer is pulled
+ */
+typedef struct {
+	size_t i_ptr;
+	uint32_t gen;
+} dg_core_slotmap_slot_t;
+
+/**
+ * Registry of arbitrary pointers with O(1) insertion, removal and validation. Stored pointers are kept packed
+ * in the ptr array, in insertion order as long as no pointer is pulled, so it can be iterated just like a
+ * dg_core_stack_t. Each pointer is also associated to a slot whose index never changes for as long as the
+ * pointer is stored, handles to these slots (dg_core_slotmap_id_t) are what's used to find or pull pointers
+ * without any scan. Freed slots are chained together and reused. n <= n_slots <= n_alloc.
+ *
+ * @param ptr     : packed array of stored pointers
+ * @param i_slot  : slot index of each stored pointer, same layout as ptr
+ * @param slots   : slot array
+ * @param n       : number of stored pointers
+ * @param n_alloc : size of allocated space of all three arrays
+ * @param n_slots : number of slots that have been used at least once
+ * @param i_free  : index of the first free slot, SIZE_MAX if there is none
+ */
+typedef struct {
+	const void **ptr;
+	size_t *i_slot;
+	dg_core_slotmap_slot_t *slots;
+	size_t n;
+	size_t n_alloc;
+	size_t n_slots;
+	size_t i_free;
+} dg_core_slotmap_t;
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Preallocate memory to the slotmap and set its variables appropriately. This function is recommended but
+ * optional to operate dg_core_slotmap_t structs because a slotmap can allocate memory automatically when
+ * needed. If n = 0, no memory is allocated and *sm is instead set to DG_CORE_SLOTMAP_EMPTY.
+ *
+ * @param sm      : slotmap to init
+ * @param n_alloc : initial allocated size of the arrays
+ *
+ * @return : true if init was successfull, false otherwhise (errno is set)
+ *
+ * @error DG_CORE_ERRNO_SLOTMAP : failure to alloc memory to the arrays
+ */
+bool dg_core_slotmap_init(dg_core_slotmap_t *sm, size_t n_alloc);
+
+/**
+ * Zeroes the slotmap and free allocated memory within the structure. The pointers that were stored are not
+ * freed. All previously issued handles become meaningless.
+ *
+ * @param sm : slotmap to reset
+ */
+void dg_core_slotmap_reset(dg_core_slotmap_t *sm);
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
+/**
+ * Checks if the given handle is still valid and refers to the given pointer.
+ *
+ * @param sm  : slotmap to search
+ * @param ptr : pointer to match
+ * @param id  : handle of the pointer
+ *
+ * @return : true if the pointer is stored under this handle, false otherwhise
+ */
+bool dg_core_slotmap_find(dg_core_slotmap_t *sm, const void *ptr, dg_core_slotmap_id_t id);
+
+/**
+ * Gets the pointer stored under a handle.
+ *
+ * @param sm : slotmap to search
+ * @param id : handle of the pointer
+ *
+ * @return : stored pointer, NULL if the handle is stale
+ */
+const void *dg_core_slotmap_get(dg_core_slotmap_t *sm, dg_core_slotmap_id_t id);
+
+/**
+ * Gets the current position of a stored pointer inside the ptr array.
+ *
+ * @param sm : slotmap to search
+ * @param id : handle of the pointer
+ *
+ * @return : position of the pointer, SIZE_MAX if the handle is stale
+ */
+size_t dg_core_slotmap_locate(dg_core_slotmap_t *sm, dg_core_slotmap_id_t id);
+
+/**
+ * Removes a pointer from the slotmap. The value pointed to by the removed pointer is not freed nor modified.
+ * The last pointer of the ptr array is moved into the freed position, so the order of the remaining pointers
+ * is not preserved. The slotmap is not shrinked. If the handle is stale, nothing happens.
+ *
+ * @param sm : slotmap to remove the pointer from
+ * @param id : handle of the pointer to pull
+ */
+void dg_core_slotmap_pull(dg_core_slotmap_t *sm, dg_core_slotmap_id_t id);
+
+/**
+ * Adds a pointer at the end of the ptr array. Unlike dg_core_stack_push(), there is no check for duplicates,
+ * it's up to the caller to not push the same pointer twice. The slotmap automatically expands as needed.
+ *
+ * @param sm  : slotmap to add the pointer to
+ * @param ptr : pointer to push
+ * @param id  : pointer whose value will be set, on success, to the handle of the newly pushed pointer. In
+ *              case of failure, *id is unmodified
+ *
+ * @return : true if the pointer was successfully added, false in case of failure (and errno is also set)
+ *
+ * @error DG_CORE_ERRNO_SLOTMAP : failure to realloc memory to the arrays
+ */
+bool dg_core_slotmap_push(dg_core_slotmap_t *sm, const void *ptr, dg_core_slotmap_id_t *id);
+
+/************************************************************************************************************/
+/************************************************************************************************************/
+/************************************************************************************************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DG_CORE_SLOTMAP_H */
@@ -36,6 +36,27 @@ static bool _extend(dg_core_stack_t *stk);
 /* PUBLIC ***************************************************************************************************/
 /************************************************************************************************************/
 
+bool
+dg_core_stack_append(dg_core_stack_t *stk, const void *ptr, size_t *pos)
+{
+	assert(stk);
+
+	if (stk->n >= stk->n_alloc && !_extend(stk)) {
+		return false;
+	}
+
+	if (pos) {
+		*pos = stk->n;
+	}
+
+	stk->ptr[stk->n] = ptr;
+	stk->n++;
+
+	return true;
+}
+
+/* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
+
 bool
 dg_core_stack_find(dg_core_stack_t *stk, const void *ptr, size_t *pos)
 {
@@ -132,18 +153,7 @@ dg_core_stack_push(dg_core_stack_t *stk, const void *ptr, size_t *pos)
 		return true;
 	}
 
-	if (stk->n >= stk->n_alloc && !_extend(stk)) {
-		return false;
-	}
-
-	if (pos) {
-		*pos = stk->n;
-	}
-
-	stk->ptr[stk->n] = ptr;
-	stk->n++;
-
-	return true;
+	return dg_core_stack_append(stk, ptr, pos);
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
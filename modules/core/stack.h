@@ -76,6 +76,21 @@ void dg_core_stack_reset(dg_core_stack_t *stk);
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
+/**
+ * Adds a pointer at the end of the stack without checking for duplicates, unlike dg_core_stack_push(). It is
+ * meant for callers that already know whether the pointer is in the stack, and can't afford a scan per push.
+ *
+ * @param stk : stack to add items to
+ * @param ptr : pointer to append to stack
+ * @param pos : optional, if non NULL, dg_core_stack_append() will put in it, on success, the position of the
+ *              pointer within the stack, in case of failure, *pos is unmodified.
+ *
+ * @return : true if the pointer was successfully added, false in case of failure (and errno is also set)
+ *
+ * @error DG_CORE_ERRNO_STACK : failure to realloc memory to the pointer array
+ */
+bool dg_core_stack_append(dg_core_stack_t *stk, const void *ptr, size_t *pos);
+
 /**
  * Checks if given item is present in the dg_core_stack.
  *
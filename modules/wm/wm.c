@@ -32,6 +32,8 @@
 #include <dg/core/core.h>
 #include <dg/core/errno.h>
 
+#include "../core/atom-private.h"
+
 #include "wm.h"
 
 /************************************************************************************************************/
@@ -52,8 +54,8 @@
 
 /* X helpers */
 
-static xcb_atom_t _x_get_atom (const char *name);
-static bool       _x_is_leader (xcb_window_t x_win);
+static void _x_get_atoms  (const dg_core_atom_req_t *reqs, size_t n, bool shared);
+static bool _x_is_leader (xcb_window_t x_win);
 
 /* procedures with side effects */
 
@@ -88,6 +90,23 @@ static xcb_atom_t _xa_acl  = 0; /* DG_CORE_ATOM_ACCEL             */
 
 static xcb_atom_t _xa_aclx[DG_CORE_CONFIG_MAX_ACCELS] = {0}; /* "_DG_WINDOW_FNx" x = 1..12 */
 
+/* atoms fetched at init, except the accelerator ones whose names are generated */
+
+static const dg_core_atom_req_t _atom_reqs[] = {
+	{ "WM_PROTOCOLS",                 &_xa_prot },
+	{ "WM_CLIENT_LEADER",             &_xa_lead },
+	{ DG_CORE_ATOM_SIGNALS,           &_xa_sig  },
+	{ DG_CORE_ATOM_VERSION,           &_xa_vers },
+	{ DG_CORE_ATOM_WINDOW_STATES,     &_xa_stt  },
+	{ DG_CORE_ATOM_WINDOW_FOCUS,      &_xa_dfoc },
+	{ DG_CORE_ATOM_WINDOW_ACTIVE,     &_xa_won  },
+	{ DG_CORE_ATOM_WINDOW_DISABLED,   &_xa_wena },
+	{ DG_CORE_ATOM_WINDOW_GRID_LOCK,  &_xa_plck },
+	{ DG_CORE_ATOM_WINDOW_FOCUS_LOCK, &_xa_flck },
+	{ DG_CORE_ATOM_RECONFIG,          &_xa_conf },
+	{ DG_CORE_ATOM_ACCEL,             &_xa_acl  },
+};
+
 /* session states */
 
 static bool _ext_x = false;
@@ -124,27 +143,26 @@ dg_wm_init(xcb_connection_t *connection)
 		goto err_crit;
 	}
 
-	/* get atoms */
-
-	_xa_prot = _x_get_atom("WM_PROTOCOLS");
-	_xa_lead = _x_get_atom("WM_CLIENT_LEADER");
-	_xa_sig  = _x_get_atom(DG_CORE_ATOM_SIGNALS);
-	_xa_vers = _x_get_atom(DG_CORE_ATOM_VERSION);
-	_xa_stt  = _x_get_atom(DG_CORE_ATOM_WINDOW_STATES);
-	_xa_dfoc = _x_get_atom(DG_CORE_ATOM_WINDOW_FOCUS);
-	_xa_won  = _x_get_atom(DG_CORE_ATOM_WINDOW_ACTIVE);
-	_xa_wena = _x_get_atom(DG_CORE_ATOM_WINDOW_DISABLED);
-	_xa_plck = _x_get_atom(DG_CORE_ATOM_WINDOW_GRID_LOCK);
-	_xa_flck = _x_get_atom(DG_CORE_ATOM_WINDOW_FOCUS_LOCK);
-	_xa_conf = _x_get_atom(DG_CORE_ATOM_RECONFIG);
-	_xa_acl  = _x_get_atom(DG_CORE_ATOM_ACCEL);
-
-	char s[20];
-	for (int i = 0; i < sizeof(_xa_aclx) / sizeof(xcb_atom_t); i++) {
-		sprintf(s, DG_CORE_ATOM_ACCEL "_%i", i + 1);
-		_xa_aclx[i] = _x_get_atom(s);
+	/* get atoms, reuse the ones already interned by the core module if it runs on the same connection */
+
+	const bool   shared = dg_core_is_init() && _x_con == dg_core_get_xcb_connection();
+	const size_t n_reqs = sizeof(_atom_reqs) / sizeof(dg_core_atom_req_t);
+
+	dg_core_atom_req_t reqs[sizeof(_atom_reqs) / sizeof(dg_core_atom_req_t) + DG_CORE_CONFIG_MAX_ACCELS];
+	char               reqs_aclx[DG_CORE_CONFIG_MAX_ACCELS][20];
+
+	for (size_t i = 0; i < n_reqs; i++) {
+		reqs[i] = _atom_reqs[i];
+	}
+
+	for (size_t i = 0; i < DG_CORE_CONFIG_MAX_ACCELS; i++) {
+		sprintf(reqs_aclx[i], DG_CORE_ATOM_ACCEL "_%zu", i + 1);
+		reqs[n_reqs + i].name = reqs_aclx[i];
+		reqs[n_reqs + i].atom = &_xa_aclx[i];
 	}
 
+	_x_get_atoms(reqs, n_reqs + DG_CORE_CONFIG_MAX_ACCELS, shared);
+
 	/* end of initialisation */
 
 	_init = true;
@@ -346,21 +364,37 @@ _reconfig_tree(xcb_window_t x_win, unsigned int depth)
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
 
-static xcb_atom_t
-_x_get_atom(const char *name)
+static void
+_x_get_atoms(const dg_core_atom_req_t *reqs, size_t n, bool shared)
 {
-	xcb_atom_t xa; 
+	xcb_intern_atom_cookie_t xc[DG_CORE_ATOM_BATCH];
+	xcb_intern_atom_reply_t *xr;
 
-	xcb_intern_atom_cookie_t xc = xcb_intern_atom(_x_con, 0, strlen(name), name);
-	xcb_intern_atom_reply_t *xr = xcb_intern_atom_reply(_x_con, xc, NULL);
-	if (!xr) {
-		dg_core_errno_set(DG_CORE_ERRNO_XCB);
-		return 0;
+	const dg_core_atom_req_t *pending[DG_CORE_ATOM_BATCH];
+
+	size_t n_pending;
+	size_t i = 0;
+
+	/* send a whole batch of intern requests before waiting on any of their replies */
+
+	while (i < n) {
+		for (n_pending = 0; i < n && n_pending < DG_CORE_ATOM_BATCH; i++) {
+			*reqs[i].atom = shared ? dg_core_get_xcb_atom(reqs[i].name) : XCB_ATOM_NONE;
+			if (*reqs[i].atom == XCB_ATOM_NONE) {
+				xc[n_pending] = xcb_intern_atom(_x_con, 0, strlen(reqs[i].name), reqs[i].name);
+				pending[n_pending++] = &reqs[i];
+			}
+		}
+		for (size_t j = 0; j < n_pending; j++) {
+			xr = xcb_intern_atom_reply(_x_con, xc[j], NULL);
+			if (!xr) {
+				dg_core_errno_set(DG_CORE_ERRNO_XCB);
+				continue;
+			}
+			*pending[j]->atom = xr->atom;
+			free(xr);
+		}
 	}
-	
-	xa = xr->atom;
-	free(xr);
-	return xa;
 }
 
 /* - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - - -*/
@@ -36,7 +36,8 @@ extern "C" {
 
 /**
  * Initialises this module and enables the other functions of this header (unless explicitely stated).
- * Should only be called once until dg_wm_reset(). Can be called again after.
+ * Should only be called once until dg_wm_reset(). Can be called again after. If the core module is already
+ * initialized on the same connection, the atoms it has interned are reused instead of being fetched again.
  *
  * @error DG_CORE_ERRNO_XCB          : failed to fetch X atoms
  * @error DG_CORE_ERRNO_XCB_CRITICAL : failed to setup an X sesssion, the module can't initialize